@@ -0,0 +1,521 @@
+/**
+ * @file bench.cpp
+ * @brief Throughput and round-trip latency of SPSCRingBuffer and other queues.
+ *
+ * Usage: spsc_bench [--iters N] [--reps R] [--capacity C]... [--cpus A,B]...
+ *
+ * Every queue is run for each core pair, element size (4, 64 and 512 bytes)
+ * and capacity. Without --cpus the pairs are picked from the sysfs topology:
+ * an SMT sibling, another core on the same socket and a core on another
+ * socket, whichever of these exist. The median of the repetitions is reported.
+ *
+ * L1D read misses and last-level cache misses per item of the throughput run
+ * are read from perf_event_open, summed over both threads, and printed as "-"
+ * when the counters are unavailable (e.g. perf_event_paranoid or a VM).
+ */
+
+#include <linux/perf_event.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <fadli/SPSCRingBuffer.hpp>
+
+#ifdef FADLI_BENCH_HAVE_BOOST
+#include <boost/lockfree/spsc_queue.hpp>
+#endif
+#ifdef FADLI_BENCH_HAVE_FOLLY
+#include <folly/ProducerConsumerQueue.h>
+#endif
+#ifdef FADLI_BENCH_HAVE_RIGTORP
+#include <rigtorp/SPSCQueue.h>
+#endif
+#ifdef FADLI_BENCH_HAVE_MOODYCAMEL
+#include <readerwriterqueue.h>
+#endif
+#ifdef FADLI_BENCH_HAVE_DRO
+#include <dro/spsc-queue.hpp>
+#endif
+
+namespace {
+
+// Element of Size bytes carrying a sequence number the consumer checks
+template <std::size_t Size>
+struct Payload {
+  static_assert(Size >= sizeof(std::uint32_t));
+
+  std::uint32_t seq;
+  std::array<std::byte, Size - sizeof(std::uint32_t)> pad;
+};
+
+template <std::size_t Size>
+Payload<Size> make_payload(std::uint32_t seq) noexcept {
+  Payload<Size> p;
+  p.seq = seq;
+  p.pad.fill(std::byte{0});
+  return p;
+}
+
+// Adapters giving every queue a try_push(const T&) / try_pop(T&) interface
+
+template <typename T>
+struct FadliQueue {
+  static constexpr const char* name = "fadli::SPSCRingBuffer";
+  explicit FadliQueue(std::size_t capacity) : q(capacity) {}
+  bool try_push(const T& v) { return q.try_push(v); }
+  bool try_pop(T& v) {
+    if (auto* p = q.front()) {
+      v = *p;
+      q.pop();
+      return true;
+    }
+    return false;
+  }
+  fadli::SPSCRingBuffer<T> q;
+};
+
+// Prefetching two slots ahead, and demoting published lines where the
+// element fills one
+template <typename T>
+struct PrefetchTraits : fadli::SPSCRingBufferTraits {
+  static constexpr std::size_t prefetch_distance = 2;
+  static constexpr fadli::CacheHint publish_hint =
+      sizeof(T) >= 64 ? fadli::CacheHint::demote : fadli::CacheHint::none;
+};
+
+template <typename T>
+struct FadliPrefetchQueue {
+  static constexpr const char* name = "fadli::SPSCRingBuffer/prefetch";
+  explicit FadliPrefetchQueue(std::size_t capacity) : q(capacity) {}
+  bool try_push(const T& v) { return q.try_push(v); }
+  bool try_pop(T& v) {
+    if (auto* p = q.front()) {
+      v = *p;
+      q.pop();
+      return true;
+    }
+    return false;
+  }
+  fadli::SPSCRingBuffer<T, fadli::dynamic_capacity, fadli::AlignedAllocator<T>,
+                        PrefetchTraits<T>>
+      q;
+};
+
+#ifdef FADLI_BENCH_HAVE_BOOST
+template <typename T>
+struct BoostQueue {
+  static constexpr const char* name = "boost::lockfree::spsc_queue";
+  explicit BoostQueue(std::size_t capacity) : q(capacity) {}
+  bool try_push(const T& v) { return q.push(v); }
+  bool try_pop(T& v) { return q.pop(v); }
+  boost::lockfree::spsc_queue<T> q;
+};
+#endif
+
+#ifdef FADLI_BENCH_HAVE_FOLLY
+template <typename T>
+struct FollyQueue {
+  static constexpr const char* name = "folly::ProducerConsumerQueue";
+  // Folly keeps one slot empty to tell full from empty
+  explicit FollyQueue(std::size_t capacity) : q(capacity + 1) {}
+  bool try_push(const T& v) { return q.write(v); }
+  bool try_pop(T& v) { return q.read(v); }
+  folly::ProducerConsumerQueue<T> q;
+};
+#endif
+
+#ifdef FADLI_BENCH_HAVE_RIGTORP
+template <typename T>
+struct RigtorpQueue {
+  static constexpr const char* name = "rigtorp::SPSCQueue";
+  explicit RigtorpQueue(std::size_t capacity) : q(capacity) {}
+  bool try_push(const T& v) { return q.try_push(v); }
+  bool try_pop(T& v) {
+    if (auto* p = q.front()) {
+      v = *p;
+      q.pop();
+      return true;
+    }
+    return false;
+  }
+  rigtorp::SPSCQueue<T> q;
+};
+#endif
+
+#ifdef FADLI_BENCH_HAVE_MOODYCAMEL
+template <typename T>
+struct MoodycamelQueue {
+  static constexpr const char* name = "moodycamel::ReaderWriterQueue";
+  explicit MoodycamelQueue(std::size_t capacity) : q(capacity) {}
+  // try_enqueue never allocates, keeping the queue bounded like the others
+  bool try_push(const T& v) { return q.try_enqueue(v); }
+  bool try_pop(T& v) { return q.try_dequeue(v); }
+  moodycamel::ReaderWriterQueue<T> q;
+};
+#endif
+
+#ifdef FADLI_BENCH_HAVE_DRO
+template <typename T>
+struct DroQueue {
+  static constexpr const char* name = "dro::SPSCQueue";
+  explicit DroQueue(std::size_t capacity) : q(capacity) {}
+  bool try_push(const T& v) { return q.try_push(v); }
+  bool try_pop(T& v) { return q.try_pop(v); }
+  dro::SPSCQueue<T> q;
+};
+#endif
+
+struct CpuPair {
+  std::string label;
+  int producer;  ///< -1 leaves the thread unpinned
+  int consumer;
+};
+
+struct Config {
+  std::uint32_t iters = 10'000'000;
+  int reps = 5;
+  std::vector<std::size_t> capacities;
+  std::vector<CpuPair> pairs;
+};
+
+void pin_thread(int cpu) {
+  if (cpu < 0) {
+    return;
+  }
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+    std::fprintf(stderr, "failed to pin thread to cpu %d\n", cpu);
+    std::exit(EXIT_FAILURE);
+  }
+}
+
+int read_topology(int cpu, const char* field) {
+  std::ifstream in("/sys/devices/system/cpu/cpu" + std::to_string(cpu) +
+                   "/topology/" + field);
+  int value = -1;
+  in >> value;
+  return value;
+}
+
+// Pairs cpu 0 with an SMT sibling, a core on its socket and a remote socket
+std::vector<CpuPair> discover_pairs() {
+  const int cpus = static_cast<int>(std::thread::hardware_concurrency());
+  const int package = read_topology(0, "physical_package_id");
+  const int core = read_topology(0, "core_id");
+  int smt = -1, socket = -1, cross = -1;
+  for (int cpu = 1; cpu < cpus; ++cpu) {
+    const int p = read_topology(cpu, "physical_package_id");
+    const int c = read_topology(cpu, "core_id");
+    if (p < 0 || c < 0) {
+      continue;
+    }
+    if (p != package) {
+      cross = cross < 0 ? cpu : cross;
+    } else if (c == core) {
+      smt = smt < 0 ? cpu : smt;
+    } else {
+      socket = socket < 0 ? cpu : socket;
+    }
+  }
+
+  std::vector<CpuPair> pairs;
+  if (smt >= 0) pairs.push_back({"smt", 0, smt});
+  if (socket >= 0) pairs.push_back({"socket", 0, socket});
+  if (cross >= 0) pairs.push_back({"cross", 0, cross});
+  if (pairs.empty()) pairs.push_back({"unpinned", -1, -1});
+  return pairs;
+}
+
+// Cache miss counters of the calling thread, user space only
+class PerfCounters {
+ public:
+  PerfCounters()
+      : l1d_(open(PERF_TYPE_HW_CACHE,
+                  PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                      (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))),
+        llc_(open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES)) {}
+
+  ~PerfCounters() {
+    if (l1d_ >= 0) ::close(l1d_);
+    if (llc_ >= 0) ::close(llc_);
+  }
+
+  PerfCounters(const PerfCounters&) = delete;
+  PerfCounters& operator=(const PerfCounters&) = delete;
+
+  void start() noexcept {
+    for (const int fd : {l1d_, llc_}) {
+      if (fd >= 0) {
+        ::ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ::ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+      }
+    }
+  }
+
+  void stop() noexcept {
+    for (const int fd : {l1d_, llc_}) {
+      if (fd >= 0) {
+        ::ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+      }
+    }
+  }
+
+  /// Counter values, or -1 where the event could not be opened
+  std::int64_t l1d_misses() const noexcept { return read(l1d_); }
+  std::int64_t llc_misses() const noexcept { return read(llc_); }
+
+ private:
+  static int open(std::uint32_t type, std::uint64_t config) noexcept {
+    perf_event_attr attr{};
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return static_cast<int>(
+        ::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+  }
+
+  static std::int64_t read(int fd) noexcept {
+    std::uint64_t value = 0;
+    if (fd < 0 || ::read(fd, &value, sizeof(value)) != sizeof(value)) {
+      return -1;
+    }
+    return static_cast<std::int64_t>(value);
+  }
+
+  int l1d_;
+  int llc_;
+};
+
+struct ThroughputResult {
+  double ops_per_sec;
+  double l1d_per_op;  ///< Negative if unavailable
+  double llc_per_op;  ///< Negative if unavailable
+};
+
+// Sums both threads' counts, keeping -1 if either side could not count
+std::int64_t combine(std::int64_t a, std::int64_t b) noexcept {
+  return a < 0 || b < 0 ? -1 : a + b;
+}
+
+double median(std::vector<double> values) {
+  std::sort(values.begin(), values.end());
+  return values[values.size() / 2];
+}
+
+// Items per second moved from a producer to a consumer thread
+template <typename Queue, std::size_t Size>
+ThroughputResult throughput(const Config& cfg, const CpuPair& pair,
+                            std::size_t capacity) {
+  using T = Payload<Size>;
+  Queue q(capacity);
+  std::atomic<bool> ready{false};
+  std::int64_t consumer_l1d = -1, consumer_llc = -1;
+
+  std::thread consumer([&] {
+    pin_thread(pair.consumer);
+    PerfCounters counters;
+    ready.store(true, std::memory_order_release);
+    counters.start();
+    T v;
+    for (std::uint32_t i = 0; i < cfg.iters; ++i) {
+      while (!q.try_pop(v)) {
+      }
+      if (v.seq != i) {
+        std::fprintf(stderr, "%s: out of order\n", Queue::name);
+        std::exit(EXIT_FAILURE);
+      }
+    }
+    counters.stop();
+    consumer_l1d = counters.l1d_misses();
+    consumer_llc = counters.llc_misses();
+  });
+
+  pin_thread(pair.producer);
+  PerfCounters counters;
+  while (!ready.load(std::memory_order_acquire)) {
+  }
+  counters.start();
+  const auto start = std::chrono::steady_clock::now();
+  for (std::uint32_t i = 0; i < cfg.iters; ++i) {
+    const auto v = make_payload<Size>(i);
+    while (!q.try_push(v)) {
+    }
+  }
+  counters.stop();
+  consumer.join();
+  const auto stop = std::chrono::steady_clock::now();
+
+  const auto per_op = [&](std::int64_t count) {
+    return count < 0 ? -1.0 : static_cast<double>(count) / cfg.iters;
+  };
+  return {cfg.iters / std::chrono::duration<double>(stop - start).count(),
+          per_op(combine(counters.l1d_misses(), consumer_l1d)),
+          per_op(combine(counters.llc_misses(), consumer_llc))};
+}
+
+// Nanoseconds for an element to go to the peer thread and back
+template <typename Queue, std::size_t Size>
+double round_trip(const Config& cfg, const CpuPair& pair,
+                  std::size_t capacity) {
+  using T = Payload<Size>;
+  const std::uint32_t iters = std::max<std::uint32_t>(cfg.iters / 10, 1);
+  Queue ping(capacity);
+  Queue pong(capacity);
+  std::atomic<bool> ready{false};
+
+  std::thread peer([&] {
+    pin_thread(pair.consumer);
+    ready.store(true, std::memory_order_release);
+    T v;
+    for (std::uint32_t i = 0; i < iters; ++i) {
+      while (!ping.try_pop(v)) {
+      }
+      while (!pong.try_push(v)) {
+      }
+    }
+  });
+
+  pin_thread(pair.producer);
+  while (!ready.load(std::memory_order_acquire)) {
+  }
+  T v;
+  const auto start = std::chrono::steady_clock::now();
+  for (std::uint32_t i = 0; i < iters; ++i) {
+    while (!ping.try_push(make_payload<Size>(i))) {
+    }
+    while (!pong.try_pop(v)) {
+    }
+  }
+  const auto stop = std::chrono::steady_clock::now();
+  peer.join();
+  return std::chrono::duration<double, std::nano>(stop - start).count() /
+         iters;
+}
+
+template <template <typename> class Queue, std::size_t Size>
+void run(const Config& cfg, const CpuPair& pair, std::size_t capacity) {
+  using Q = Queue<Payload<Size>>;
+  std::vector<double> ops, l1d, llc, rtt;
+  for (int r = 0; r < cfg.reps; ++r) {
+    const auto result = throughput<Q, Size>(cfg, pair, capacity);
+    ops.push_back(result.ops_per_sec);
+    l1d.push_back(result.l1d_per_op);
+    llc.push_back(result.llc_per_op);
+    rtt.push_back(round_trip<Q, Size>(cfg, pair, capacity));
+  }
+
+  const auto misses = [](const std::vector<double>& values) {
+    const auto m = median(values);
+    char buf[32];
+    if (m < 0) {
+      std::snprintf(buf, sizeof(buf), "-");
+    } else {
+      std::snprintf(buf, sizeof(buf), "%.3f", m);
+    }
+    return std::string(buf);
+  };
+  std::printf("%-30s %-9s %5zu %9zu %12.2f %10.1f %8s %8s\n", Q::name,
+              pair.label.c_str(), Size, capacity, median(ops) / 1e6,
+              median(rtt), misses(l1d).c_str(), misses(llc).c_str());
+  std::fflush(stdout);
+}
+
+template <std::size_t Size>
+void run_all(const Config& cfg, const CpuPair& pair, std::size_t capacity) {
+  run<FadliQueue, Size>(cfg, pair, capacity);
+  run<FadliPrefetchQueue, Size>(cfg, pair, capacity);
+#ifdef FADLI_BENCH_HAVE_RIGTORP
+  run<RigtorpQueue, Size>(cfg, pair, capacity);
+#endif
+#ifdef FADLI_BENCH_HAVE_FOLLY
+  run<FollyQueue, Size>(cfg, pair, capacity);
+#endif
+#ifdef FADLI_BENCH_HAVE_BOOST
+  run<BoostQueue, Size>(cfg, pair, capacity);
+#endif
+#ifdef FADLI_BENCH_HAVE_MOODYCAMEL
+  run<MoodycamelQueue, Size>(cfg, pair, capacity);
+#endif
+#ifdef FADLI_BENCH_HAVE_DRO
+  run<DroQueue, Size>(cfg, pair, capacity);
+#endif
+}
+
+[[noreturn]] void usage(const char* argv0) {
+  std::fprintf(stderr,
+               "usage: %s [--iters N] [--reps R] [--capacity C]... "
+               "[--cpus A,B]...\n",
+               argv0);
+  std::exit(EXIT_FAILURE);
+}
+
+Config parse_args(int argc, char** argv) {
+  Config cfg;
+  for (int i = 1; i < argc; ++i) {
+    const std::string_view arg = argv[i];
+    if (i + 1 >= argc) {
+      usage(argv[0]);
+    }
+    const char* value = argv[++i];
+    if (arg == "--iters") {
+      cfg.iters = static_cast<std::uint32_t>(std::strtoul(value, nullptr, 10));
+    } else if (arg == "--reps") {
+      cfg.reps = std::max(1, std::atoi(value));
+    } else if (arg == "--capacity") {
+      cfg.capacities.push_back(std::strtoull(value, nullptr, 10));
+    } else if (arg == "--cpus") {
+      int producer = -1, consumer = -1;
+      if (std::sscanf(value, "%d,%d", &producer, &consumer) != 2) {
+        usage(argv[0]);
+      }
+      cfg.pairs.push_back({value, producer, consumer});
+    } else {
+      usage(argv[0]);
+    }
+  }
+  if (cfg.capacities.empty()) {
+    cfg.capacities = {1024, 65536};
+  }
+  if (cfg.pairs.empty()) {
+    cfg.pairs = discover_pairs();
+  }
+  return cfg;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const Config cfg = parse_args(argc, argv);
+
+  std::printf("%-30s %-9s %5s %9s %12s %10s %8s %8s\n", "queue", "cpus",
+              "bytes", "capacity", "Mops/s", "RTT ns", "L1D/op", "LLC/op");
+  for (const auto& pair : cfg.pairs) {
+    for (const auto capacity : cfg.capacities) {
+      run_all<4>(cfg, pair, capacity);
+      run_all<64>(cfg, pair, capacity);
+      run_all<512>(cfg, pair, capacity);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,290 @@
+/**
+ * @file Allocators.hpp
+ * @brief Huge page and NUMA-aware allocators for SPSCRingBuffer storage.
+ * @author Fadli Arsani <fadlialim0029@gmail.com>
+ * @version 1.0.0
+ *
+ * MIT License
+ *
+ * Copyright (c) 2025 Fadli Arsani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#if !defined(__linux__)
+#error "fadli/Allocators.hpp requires Linux (mmap, madvise, mbind)"
+#endif
+
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <system_error>
+
+namespace fadli {
+
+/**
+ * @brief Page size backing an allocation
+ */
+enum class PageSize {
+  standard,          ///< Regular base pages (usually 4 KiB)
+  transparent_huge,  ///< Base pages with madvise(MADV_HUGEPAGE)
+  huge_2mb,          ///< Explicit 2 MiB hugetlbfs pages
+  huge_1gb,          ///< Explicit 1 GiB hugetlbfs pages
+};
+
+namespace detail {
+
+inline constexpr std::size_t base_page_size = 4096;
+
+constexpr std::size_t page_bytes(PageSize page_size) noexcept {
+  switch (page_size) {
+    case PageSize::huge_1gb:
+      return std::size_t{1} << 30;
+    case PageSize::huge_2mb:
+    case PageSize::transparent_huge:
+      return std::size_t{1} << 21;
+    case PageSize::standard:
+      break;
+  }
+  return base_page_size;
+}
+
+constexpr std::size_t round_up(std::size_t n, std::size_t multiple) noexcept {
+  return (n + multiple - 1) / multiple * multiple;
+}
+
+/**
+ * @brief Maps, binds and optionally pre-faults anonymous memory
+ *
+ * Shared state and logic of HugePageAllocator and NumaAllocator. Explicit
+ * hugetlbfs pages fall back to transparent huge pages when none are reserved.
+ */
+class page_mapper {
+ public:
+  constexpr page_mapper(PageSize page_size, int numa_node,
+                        bool prefault) noexcept
+      : page_size_(page_size), numa_node_(numa_node), prefault_(prefault) {}
+
+  [[nodiscard]] void* map(std::size_t bytes) const {
+    const auto length = round_up(bytes, page_bytes(page_size_));
+    void* p = MAP_FAILED;
+    if (page_size_ == PageSize::huge_2mb || page_size_ == PageSize::huge_1gb) {
+      const int huge_flag =
+          page_size_ == PageSize::huge_1gb ? (30 << MAP_HUGE_SHIFT)
+                                           : (21 << MAP_HUGE_SHIFT);
+      // Without NUMA binding the kernel may populate for us up front
+      const int populate = prefault_ && numa_node_ < 0 ? MAP_POPULATE : 0;
+      p = ::mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | huge_flag |
+                     populate,
+                 -1, 0);
+    }
+    if (p == MAP_FAILED) {
+      p = page_size_ == PageSize::standard ? map_base_pages(length)
+                                           : map_transparent_huge(length);
+    }
+
+    if (numa_node_ >= 0) {
+      bind(p, length);
+    }
+    if (prefault_) {
+      // Touch every base page so faults land on the bound node at
+      // construction instead of on the hot path. Only the requested bytes:
+      // the tail of a rounded-up fallback mapping may never be used.
+      auto* bytes_ptr = static_cast<volatile unsigned char*>(p);
+      for (std::size_t off = 0; off < bytes; off += base_page_size) {
+        bytes_ptr[off] = 0;
+      }
+    }
+    return p;
+  }
+
+  void unmap(void* p, std::size_t bytes) const noexcept {
+    ::munmap(p, round_up(bytes, page_bytes(page_size_)));
+  }
+
+  [[nodiscard]] PageSize page_size() const noexcept { return page_size_; }
+  [[nodiscard]] int numa_node() const noexcept { return numa_node_; }
+  [[nodiscard]] bool prefault() const noexcept { return prefault_; }
+
+  friend bool operator==(const page_mapper&,
+                         const page_mapper&) noexcept = default;
+
+ private:
+  static void* map_base_pages(std::size_t length) {
+    void* p = ::mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) {
+      throw std::bad_alloc();
+    }
+    return p;
+  }
+
+  // khugepaged only collapses 2 MiB-aligned ranges, so over-allocate, trim
+  // the mapping to an aligned start and then advise it
+  static void* map_transparent_huge(std::size_t length) {
+    constexpr auto huge = page_bytes(PageSize::transparent_huge);
+    auto* raw = static_cast<unsigned char*>(
+        map_base_pages(length + huge - base_page_size));
+    const auto address = reinterpret_cast<std::uintptr_t>(raw);
+    const auto head = round_up(address, huge) - address;
+    const auto tail = huge - base_page_size - head;
+    if (head != 0) {
+      ::munmap(raw, head);
+    }
+    if (tail != 0) {
+      ::munmap(raw + head + length, tail);
+    }
+    ::madvise(raw + head, length, MADV_HUGEPAGE);  // Best effort
+    return raw + head;
+  }
+
+  void bind(void* p, std::size_t length) const {
+    constexpr std::size_t bits_per_word = sizeof(unsigned long) * CHAR_BIT;
+    std::array<unsigned long, 16> node_mask{};
+    const auto node = static_cast<std::size_t>(numa_node_);
+    if (node >= node_mask.size() * bits_per_word) {
+      unmap(p, length);
+      throw std::system_error(EINVAL, std::generic_category(),
+                              "NUMA node out of range");
+    }
+    node_mask[node / bits_per_word] |= 1UL << (node % bits_per_word);
+    // The kernel reads maxnode - 1 bits, so pass one more than the mask has
+    if (::syscall(SYS_mbind, p, length, MPOL_BIND, node_mask.data(),
+                  node_mask.size() * bits_per_word + 1, 0) != 0) {
+      const int error = errno;
+      unmap(p, length);
+      throw std::system_error(error, std::generic_category(), "mbind");
+    }
+  }
+
+  PageSize page_size_;
+  int numa_node_;  ///< Node to bind to, or -1 for the default policy
+  bool prefault_;
+};
+
+}  // namespace detail
+
+/**
+ * @brief Allocator backed by huge pages
+ * @tparam T The type of elements to allocate
+ * @note Each allocation is its own mapping, rounded up to the page size, so
+ *       use it for large, long-lived buffers such as SPSCRingBuffer slots
+ * @code
+ * using Alloc = fadli::HugePageAllocator<Msg>;
+ * fadli::SPSCRingBuffer<Msg, fadli::dynamic_capacity, Alloc> q(
+ *     1 << 20, Alloc(fadli::PageSize::huge_2mb, true));
+ * @endcode
+ */
+template <typename T>
+class HugePageAllocator {
+ public:
+  using value_type = T;
+
+  /**
+   * @brief Constructs the allocator
+   * @param page_size Page size to request
+   * @param prefault Touch every page during allocate()
+   */
+  explicit HugePageAllocator(PageSize page_size = PageSize::huge_2mb,
+                             bool prefault = false) noexcept
+      : mapper_(page_size, -1, prefault) {}
+
+  template <typename U>
+  HugePageAllocator(const HugePageAllocator<U>& other) noexcept
+      : mapper_(other.mapper_) {}
+
+  [[nodiscard]] T* allocate(std::size_t n) {
+    if (n > std::size_t(-1) / sizeof(T)) {
+      throw std::bad_array_new_length();
+    }
+    return static_cast<T*>(mapper_.map(n * sizeof(T)));
+  }
+
+  void deallocate(T* p, std::size_t n) noexcept {
+    mapper_.unmap(p, n * sizeof(T));
+  }
+
+  friend bool operator==(const HugePageAllocator&,
+                         const HugePageAllocator&) noexcept = default;
+
+ private:
+  template <typename U>
+  friend class HugePageAllocator;
+
+  detail::page_mapper mapper_;
+};
+
+/**
+ * @brief Allocator binding its memory to a single NUMA node
+ * @tparam T The type of elements to allocate
+ * @note Combine with prefault so pages are placed when the buffer is
+ *       constructed rather than on first touch by whichever thread gets there
+ */
+template <typename T>
+class NumaAllocator {
+ public:
+  using value_type = T;
+
+  /**
+   * @brief Constructs the allocator
+   * @param node NUMA node the memory is bound to (MPOL_BIND)
+   * @param page_size Page size to request
+   * @param prefault Touch every page during allocate()
+   */
+  explicit NumaAllocator(int node, PageSize page_size = PageSize::standard,
+                         bool prefault = false) noexcept
+      : mapper_(page_size, node, prefault) {}
+
+  template <typename U>
+  NumaAllocator(const NumaAllocator<U>& other) noexcept
+      : mapper_(other.mapper_) {}
+
+  [[nodiscard]] T* allocate(std::size_t n) {
+    if (n > std::size_t(-1) / sizeof(T)) {
+      throw std::bad_array_new_length();
+    }
+    return static_cast<T*>(mapper_.map(n * sizeof(T)));
+  }
+
+  void deallocate(T* p, std::size_t n) noexcept {
+    mapper_.unmap(p, n * sizeof(T));
+  }
+
+  friend bool operator==(const NumaAllocator&,
+                         const NumaAllocator&) noexcept = default;
+
+ private:
+  template <typename U>
+  friend class NumaAllocator;
+
+  detail::page_mapper mapper_;
+};
+
+}  // namespace fadli
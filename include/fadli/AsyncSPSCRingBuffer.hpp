@@ -0,0 +1,293 @@
+/**
+ * @file AsyncSPSCRingBuffer.hpp
+ * @brief Coroutine awaitable push and pop over an spsc ring buffer.
+ * @author Fadli Arsani <fadlialim0029@gmail.com>
+ * @version 1.0.0
+ *
+ * MIT License
+ *
+ * Copyright (c) 2025 Fadli Arsani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <concepts>
+#include <coroutine>
+#include <cstddef>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "SPSCRingBuffer.hpp"
+
+namespace fadli {
+
+/**
+ * @brief Executor that resumes a coroutine on the calling thread
+ *
+ * The default for AsyncSPSCRingBuffer: the coroutine waiting on one side runs
+ * inside the other side's push or pop, until it next suspends.
+ */
+struct InlineExecutor {
+  void post(std::coroutine_handle<> handle) const { handle.resume(); }
+};
+
+/**
+ * @brief What AsyncSPSCRingBuffer needs from an executor: post(handle)
+ *        schedules handle.resume(), on whatever thread the executor owns
+ */
+template <typename E>
+concept CoroutineExecutor = requires(E& executor, std::coroutine_handle<> h) {
+  executor.post(h);
+};
+
+/**
+ * @brief SPSCRingBuffer with co_await-able push and pop
+ * @tparam T The type of elements stored in the ring buffer
+ * @tparam Executor Where a suspended coroutine is resumed; see
+ *         CoroutineExecutor
+ * @tparam Allocator Allocator for the slot array
+ *
+ * co_push() suspends the producer coroutine while the ring is full and
+ * co_pop() suspends the consumer coroutine while it is empty. With one
+ * producer and one consumer there is at most one waiting handle per side,
+ * kept in an atomic slot. The other side posts it to the executor after
+ * the push or pop that unblocks it, so no thread blocks or spins.
+ *
+ * A side registers its handle and then re-checks the ring. The other side
+ * pushes or pops and then checks the slot. Both separate their write from
+ * the following read with a seq_cst fence, so either the waker sees the
+ * handle or the waiter sees the change. Whichever side then takes the
+ * handle out of the slot resumes it, so it is resumed exactly once.
+ * try_push() and try_pop() wake the other side as well, so plain threads
+ * and coroutines can share a ring.
+ * @warning This class is NOT thread-safe for multiple producers or consumers,
+ *          and a suspended coroutine must not be destroyed before it is
+ *          resumed.
+ * @code
+ * fadli::AsyncSPSCRingBuffer<Packet, Pool> q(1024, pool);
+ *
+ * task decode(socket& s) {
+ *     for (;;) co_await q.co_push(co_await s.read_packet());
+ * }
+ * task handle() {
+ *     for (;;) process(co_await q.co_pop());
+ * }
+ * @endcode
+ */
+template <typename T, CoroutineExecutor Executor = InlineExecutor,
+          typename Allocator = AlignedAllocator<T>>
+class AsyncSPSCRingBuffer {
+ public:
+  using ring_type = SPSCRingBuffer<T, dynamic_capacity, Allocator>;
+  using value_type = T;
+  using size_type = std::size_t;
+  using executor_type = Executor;
+
+  /**
+   * @brief Constructs a ring buffer with the specified capacity
+   * @param capacity Desired capacity (will be rounded up to power of 2)
+   * @param executor Executor that resumes suspended coroutines
+   * @param alloc Allocator for the slot array
+   * @throws std::bad_alloc If memory allocation fails
+   */
+  explicit AsyncSPSCRingBuffer(size_type capacity, Executor executor = {},
+                               const Allocator& alloc = Allocator())
+      : ring_(capacity, alloc), executor_(std::move(executor)) {}
+
+  /**
+   * @brief Awaitable returned by co_push()
+   */
+  class push_awaiter {
+   public:
+    [[nodiscard]] bool await_ready() {
+      pushed_ = queue_.try_push(std::move(item_));
+      return pushed_;
+    }
+
+    bool await_suspend(std::coroutine_handle<> handle) {
+      return queue_.suspend(queue_.producer_waiter_, handle,
+                            [queue = &queue_] { return queue->ring_.full(); });
+    }
+
+    void await_resume() {
+      if (!pushed_) {
+        // We were only resumed because a slot is free, and only we push
+        pushed_ = queue_.try_push(std::move(item_));
+        assert(pushed_ && "resumed producer found the ring full");
+      }
+    }
+
+   private:
+    friend AsyncSPSCRingBuffer;
+    push_awaiter(AsyncSPSCRingBuffer& queue, T&& item)
+        : queue_(queue), item_(std::move(item)) {}
+
+    AsyncSPSCRingBuffer& queue_;
+    T item_;
+    bool pushed_{false};
+  };
+
+  /**
+   * @brief Awaitable returned by co_pop()
+   */
+  class pop_awaiter {
+   public:
+    [[nodiscard]] bool await_ready() {
+      item_ = queue_.try_pop();
+      return item_.has_value();
+    }
+
+    bool await_suspend(std::coroutine_handle<> handle) {
+      return queue_.suspend(queue_.consumer_waiter_, handle,
+                            [queue = &queue_] { return queue->ring_.empty(); });
+    }
+
+    [[nodiscard]] T await_resume() {
+      if (!item_) {
+        item_ = queue_.try_pop();
+        assert(item_ && "resumed consumer found the ring empty");
+      }
+      return std::move(*item_);
+    }
+
+   private:
+    friend AsyncSPSCRingBuffer;
+    explicit pop_awaiter(AsyncSPSCRingBuffer& queue) : queue_(queue) {}
+
+    AsyncSPSCRingBuffer& queue_;
+    std::optional<T> item_;
+  };
+
+  /**
+   * @brief Push an element, suspending the calling coroutine while full
+   * @param item The element to add to the buffer
+   * @return An awaitable completing once the element is in the buffer
+   * @note This function should only be called from the producer coroutine
+   */
+  [[nodiscard]] push_awaiter co_push(T item) {
+    return push_awaiter(*this, std::move(item));
+  }
+
+  /**
+   * @brief Pop an element, suspending the calling coroutine while empty
+   * @return An awaitable yielding the popped element
+   * @note This function should only be called from the consumer coroutine
+   */
+  [[nodiscard]] pop_awaiter co_pop() { return pop_awaiter(*this); }
+
+  /**
+   * @brief Attempt to push an element, resuming a waiting consumer
+   * @param item The element to add to the buffer
+   * @return true if the element was successfully added, false if buffer full
+   * @note This function should only be called from the producer side
+   */
+  template <typename U>
+    requires std::constructible_from<T, U&&>
+  [[nodiscard]] bool try_push(U&& item) {
+    if (!ring_.try_emplace(std::forward<U>(item))) {
+      return false;
+    }
+    wake(consumer_waiter_);
+    return true;
+  }
+
+  /**
+   * @brief Attempt to pop an element, resuming a waiting producer
+   * @return std::optional containing the popped element if successful,
+   *         std::nullopt if buffer is empty
+   * @note This function should only be called from the consumer side
+   */
+  [[nodiscard]] std::optional<T> try_pop() {
+    auto item = ring_.try_pop();
+    if (item) {
+      wake(producer_waiter_);
+    }
+    return item;
+  }
+
+  /**
+   * @brief Check if the buffer appears empty
+   * @return true if the buffer appears empty at the time of the call
+   * @note This is an approximate check due to concurrent access.
+   */
+  [[nodiscard]] bool empty() const noexcept { return ring_.empty(); }
+
+  /**
+   * @brief Get the approximate current size
+   * @return The approximate number of elements in the buffer
+   * @note This is an approximate value due to concurrent access.
+   */
+  [[nodiscard]] size_type size() const noexcept { return ring_.size(); }
+
+  /**
+   * @brief Get the maximum capacity
+   * @return The maximum number of elements this buffer can hold
+   */
+  [[nodiscard]] size_type capacity() const noexcept {
+    return ring_.capacity();
+  }
+
+  /**
+   * @brief Get the executor
+   * @return The executor that resumes suspended coroutines
+   */
+  [[nodiscard]] executor_type& executor() noexcept { return executor_; }
+
+ private:
+  // Registers handle, then re-checks; returns whether to stay suspended.
+  // Losing the exchange means the other side took the handle and resumes it.
+  // The release store publishes the suspended frame to whoever resumes it,
+  // and from then on the frame, awaiter included, must not be touched.
+  template <typename Blocked>
+  bool suspend(std::atomic<void*>& waiter, std::coroutine_handle<> handle,
+               Blocked blocked) {
+    waiter.store(handle.address(), std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (blocked()) {
+      return true;
+    }
+    return waiter.exchange(nullptr, std::memory_order_acq_rel) == nullptr;
+  }
+
+  void wake(std::atomic<void*>& waiter) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiter.load(std::memory_order_relaxed) == nullptr) {
+      return;
+    }
+    if (void* address = waiter.exchange(nullptr, std::memory_order_acq_rel)) {
+      executor_.post(std::coroutine_handle<>::from_address(address));
+    }
+  }
+
+  ring_type ring_;
+  [[no_unique_address]] Executor executor_;
+
+  // Separate cache lines: each is written by one side and read by the other
+  alignas(detail::cache_line_size) std::atomic<void*> producer_waiter_{
+      nullptr};
+  alignas(detail::cache_line_size) std::atomic<void*> consumer_waiter_{
+      nullptr};
+};
+
+}  // namespace fadli
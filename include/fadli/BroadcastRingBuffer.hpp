@@ -0,0 +1,450 @@
+/**
+ * @file BroadcastRingBuffer.hpp
+ * @brief A lock-free ring with one producer and many independent readers.
+ * @author Fadli Arsani <fadlialim0029@gmail.com>
+ * @version 1.0.0
+ *
+ * MIT License
+ *
+ * Copyright (c) 2025 Fadli Arsani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <type_traits>
+
+#include "SPSCRingBuffer.hpp"
+
+namespace fadli {
+
+/**
+ * @brief What BroadcastRingBuffer does when the slowest reader is a full
+ *        buffer behind
+ */
+enum class BroadcastMode {
+  gated,      ///< The producer waits for the slowest reader
+  overwrite,  ///< The producer overwrites, and lapped readers skip ahead
+};
+
+/**
+ * @brief Lock-free ring with one producer and several independent readers
+ * @tparam T The type of elements stored in the ring buffer
+ * @tparam Mode Whether the producer is gated by the slowest reader or
+ *         overwrites slots that readers have not reached yet
+ * @tparam Allocator Allocator for the slots, rebound to the slot type
+ *
+ * Every reader sees every element: the producer writes each element once
+ * into a shared slot array, and each reader advances its own cursor on its
+ * own cache line. This replaces one SPSCRingBuffer per reader, and with it
+ * N - 1 copies of every element and of the buffer.
+ *
+ * In gated mode a slot is reused only once every reader has popped it. The
+ * producer caches the slowest cursor and rescans the readers only when that
+ * cache says the buffer is full. Elements are destroyed when their slot is
+ * reused, or by the destructor.
+ *
+ * In overwrite mode the producer never waits. Each slot carries a seqlock
+ * sequence naming the position it holds, so a reader that was lapped, or
+ * whose copy was torn by a concurrent write, notices, drops the lost
+ * elements and counts them in overruns(). T must be trivially copyable, and
+ * readers only get copies.
+ * @warning Each reader index must be used by a single thread only.
+ * @code
+ * fadli::BroadcastRingBuffer<Tick> q(4096, 8);
+ *
+ * // Producer thread
+ * while (!q.try_push(tick));
+ *
+ * // Reader thread i
+ * while (const Tick* t = q.front(i)) {
+ *     handle(*t);
+ *     q.pop(i);
+ * }
+ * @endcode
+ */
+template <typename T, BroadcastMode Mode = BroadcastMode::gated,
+          typename Allocator = AlignedAllocator<T>>
+class BroadcastRingBuffer {
+  static constexpr bool overwrite = Mode == BroadcastMode::overwrite;
+
+  static_assert(std::is_nothrow_destructible_v<T>,
+                "T must be nothrow destructible");
+  static_assert(!overwrite || std::is_trivially_copyable_v<T>,
+                "overwrite mode requires a trivially copyable T");
+  static_assert(std::is_same_v<typename Allocator::value_type, T>,
+                "Allocator::value_type must be T");
+
+  // Holds the element pushed at pos once sequence == 2 * pos + 2; odd while
+  // the producer is writing it
+  struct overwrite_slot {
+    std::atomic<std::size_t> sequence;
+    detail::seqlock_cell<T> value;
+  };
+
+  using slot_type = std::conditional_t<overwrite, overwrite_slot, T>;
+  using alloc_traits = std::allocator_traits<Allocator>;
+  using slot_allocator =
+      typename alloc_traits::template rebind_alloc<slot_type>;
+  using slot_traits = std::allocator_traits<slot_allocator>;
+
+ public:
+  using value_type = T;
+  using size_type = std::size_t;
+  using allocator_type = Allocator;
+
+  /**
+   * @brief Constructs a ring buffer with the specified capacity
+   * @param capacity Desired capacity (will be rounded up to power of 2)
+   * @param readers Number of readers, each with its own cursor
+   * @param alloc Allocator for the slots
+   * @throws std::bad_alloc If memory allocation fails
+   */
+  BroadcastRingBuffer(size_type capacity, size_type readers,
+                      const Allocator& alloc = Allocator())
+      : capacity_(detail::next_power_of_2(capacity)),
+        index_mask_(capacity_ - 1),
+        readers_count_(readers),
+        alloc_(alloc),
+        readers_(std::make_unique<reader_state[]>(readers)) {
+    slot_allocator slots(alloc_);
+    slots_ = std::to_address(slot_traits::allocate(slots, capacity_));
+    if constexpr (overwrite) {
+      for (size_type i = 0; i < capacity_; ++i) {
+        std::construct_at(&slots_[i]);
+      }
+    }
+  }
+
+  /**
+   * @brief Destructor
+   * @note Destroys any elements still held in the slots
+   */
+  ~BroadcastRingBuffer() {
+    if constexpr (!overwrite && !std::is_trivially_destructible_v<T>) {
+      const auto tail = tail_.load(std::memory_order_relaxed);
+      for (auto pos = producer_.live_from; pos != tail; ++pos) {
+        alloc_traits::destroy(alloc_, &slot(pos));
+      }
+    }
+    slot_allocator slots(alloc_);
+    slot_traits::deallocate(slots, slots_, capacity_);
+  }
+
+  // Non-copyable and non-movable for safety
+  BroadcastRingBuffer(const BroadcastRingBuffer&) = delete;
+  BroadcastRingBuffer& operator=(const BroadcastRingBuffer&) = delete;
+  BroadcastRingBuffer(BroadcastRingBuffer&&) = delete;
+  BroadcastRingBuffer& operator=(BroadcastRingBuffer&&) = delete;
+
+  /**
+   * @brief Attempt to construct an element in place
+   * @param args Arguments forwarded to the constructor of T
+   * @return true if the element was added, false if the slowest reader is a
+   *         full buffer behind; always true in overwrite mode
+   * @note This function should only be called from the producer thread
+   */
+  template <typename... Args>
+  [[nodiscard]] bool try_emplace(Args&&... args) noexcept(
+      std::is_nothrow_constructible_v<T, Args&&...>) {
+    const auto tail = producer_.tail;
+
+    if constexpr (overwrite) {
+      overwrite_slot& s = slot(tail);
+      s.sequence.store(2 * tail + 1, std::memory_order_relaxed);
+      s.value.store(T(std::forward<Args>(args)...));
+      s.sequence.store(2 * tail + 2, std::memory_order_release);
+    } else {
+      if (tail - producer_.head_cache == capacity_) {
+        producer_.head_cache = slowest_head(tail);
+        if (tail - producer_.head_cache == capacity_) {
+          return false;
+        }
+      }
+      // Every reader is past the element a lap ago, so it can go. If the
+      // constructor below throws, live_from keeps it from going twice.
+      if (tail - producer_.live_from >= capacity_) {
+        alloc_traits::destroy(alloc_, &slot(tail));
+        ++producer_.live_from;
+      }
+      alloc_traits::construct(alloc_, &slot(tail),
+                              std::forward<Args>(args)...);
+    }
+
+    producer_.tail = tail + 1;
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Attempt to push an element (copy version)
+   * @param item The element to add to the buffer
+   * @return true if the element was added, false if the slowest reader is a
+   *         full buffer behind; always true in overwrite mode
+   * @note This function should only be called from the producer thread
+   */
+  [[nodiscard]] bool try_push(const T& item) noexcept(
+      std::is_nothrow_copy_constructible_v<T>) {
+    return try_emplace(item);
+  }
+
+  /**
+   * @brief Attempt to push an element (move version)
+   * @param item The element to move into the buffer
+   * @return true if the element was added, false if the slowest reader is a
+   *         full buffer behind; always true in overwrite mode
+   * @note This function should only be called from the producer thread
+   */
+  [[nodiscard]] bool try_push(T&& item) noexcept(
+      std::is_nothrow_move_constructible_v<T>) {
+    return try_emplace(std::move(item));
+  }
+
+  /**
+   * @brief Push an element, overwriting the oldest one if a reader lags
+   * @param item The element to add to the buffer
+   * @note Only available in overwrite mode, from the producer thread
+   */
+  void push(const T& item) noexcept
+    requires(overwrite)
+  {
+    (void)try_emplace(item);
+  }
+
+  /**
+   * @brief Get pointer to a reader's front element without removing it
+   * @param reader Index of the calling reader
+   * @return Pointer to the front element, or nullptr if that reader has
+   *         caught up with the producer
+   * @note Only available in gated mode, from that reader's thread
+   * @note The element is shared with the other readers, hence const. You
+   *       must call pop() after processing it.
+   */
+  [[nodiscard]] const T* front(size_type reader) noexcept
+    requires(!overwrite)
+  {
+    reader_state& r = readers_[reader];
+    const auto head = r.head.load(std::memory_order_relaxed);
+    if (head == r.tail_cache) {
+      r.tail_cache = tail_.load(std::memory_order_acquire);
+      if (head == r.tail_cache) {
+        return nullptr;
+      }
+    }
+    return &slot(head);
+  }
+
+  /**
+   * @brief Advance a reader past its front element
+   * @param reader Index of the calling reader
+   * @note Only available in gated mode, from that reader's thread
+   * @warning Calling pop() without a successful front() is undefined behavior
+   */
+  void pop(size_type reader) noexcept
+    requires(!overwrite)
+  {
+    reader_state& r = readers_[reader];
+    const auto head = r.head.load(std::memory_order_relaxed);
+    assert(head != tail_.load(std::memory_order_relaxed) &&
+           "pop() called on empty buffer");
+    r.head.store(head + 1, std::memory_order_release);
+  }
+
+  /**
+   * @brief Attempt to read a reader's next element
+   * @param reader Index of the calling reader
+   * @return std::optional containing a copy of the element if successful,
+   *         std::nullopt if that reader has caught up with the producer
+   * @note This function should only be called from that reader's thread
+   * @note In overwrite mode, elements the producer has overwritten before
+   *       they could be read are skipped and added to overruns()
+   */
+  [[nodiscard]] std::optional<T> try_pop(size_type reader) noexcept(
+      std::is_nothrow_copy_constructible_v<T>) {
+    if constexpr (overwrite) {
+      reader_state& r = readers_[reader];
+      auto head = r.head.load(std::memory_order_relaxed);
+      size_type lost = 0;
+      std::optional<T> item;
+
+      for (;;) {
+        if (head == r.tail_cache) {
+          r.tail_cache = tail_.load(std::memory_order_acquire);
+          if (head == r.tail_cache) {
+            break;
+          }
+        }
+        if (r.tail_cache - head > capacity_) {
+          lost += r.tail_cache - capacity_ - head;
+          head = r.tail_cache - capacity_;
+        }
+
+        const overwrite_slot& s = slot(head);
+        const auto expected = 2 * head + 2;
+        if (s.sequence.load(std::memory_order_acquire) == expected) {
+          const T value = s.value.load();
+          if (s.sequence.load(std::memory_order_relaxed) == expected) {
+            item.emplace(value);
+            ++head;
+            break;
+          }
+        }
+        // The producer is rewriting this slot a lap later, so it is lost
+        ++lost;
+        ++head;
+      }
+
+      if (lost != 0) {
+        r.overruns.store(r.overruns.load(std::memory_order_relaxed) + lost,
+                         std::memory_order_relaxed);
+      }
+      r.head.store(head, std::memory_order_release);
+      return item;
+    } else {
+      const T* front_item = front(reader);
+      if (front_item == nullptr) {
+        return std::nullopt;
+      }
+      std::optional<T> item(*front_item);
+      pop(reader);
+      return item;
+    }
+  }
+
+  /**
+   * @brief Read the newest element, skipping everything older
+   * @param reader Index of the calling reader
+   * @return std::optional containing a copy of the newest element, or
+   *         std::nullopt if that reader has caught up with the producer
+   * @note Only available in overwrite mode, from that reader's thread
+   * @note Elements skipped on purpose are not added to overruns()
+   */
+  [[nodiscard]] std::optional<T> try_pop_latest(size_type reader) noexcept
+    requires(overwrite)
+  {
+    reader_state& r = readers_[reader];
+    r.tail_cache = tail_.load(std::memory_order_acquire);
+    const auto head = r.head.load(std::memory_order_relaxed);
+    if (r.tail_cache - head > 1) {
+      r.head.store(r.tail_cache - 1, std::memory_order_relaxed);
+    }
+    return try_pop(reader);
+  }
+
+  /**
+   * @brief Get the number of elements a reader has lost to the producer
+   * @param reader Index of the reader
+   * @return Elements skipped because they were overwritten; always 0 in
+   *         gated mode
+   * @note Safe to call from any thread; the count only grows
+   */
+  [[nodiscard]] size_type overruns(size_type reader) const noexcept {
+    return readers_[reader].overruns.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Check if a reader appears to have caught up with the producer
+   * @param reader Index of the reader
+   * @return true if that reader has nothing to read at the time of the call
+   * @note This is an approximate check due to concurrent access.
+   */
+  [[nodiscard]] bool empty(size_type reader) const noexcept {
+    return size(reader) == 0;
+  }
+
+  /**
+   * @brief Get the approximate number of elements a reader has yet to read
+   * @param reader Index of the reader
+   * @return The reader's lag behind the producer, at most capacity()
+   * @note This is an approximate value due to concurrent access.
+   */
+  [[nodiscard]] size_type size(size_type reader) const noexcept {
+    const auto head = readers_[reader].head.load(std::memory_order_acquire);
+    const auto tail = tail_.load(std::memory_order_relaxed);
+    return std::min(tail - head, capacity_);
+  }
+
+  /**
+   * @brief Get the number of readers
+   * @return The reader count given at construction
+   */
+  [[nodiscard]] size_type readers() const noexcept { return readers_count_; }
+
+  /**
+   * @brief Get the maximum capacity
+   * @return The maximum number of elements a reader can lag behind
+   */
+  [[nodiscard]] size_type capacity() const noexcept { return capacity_; }
+
+  /**
+   * @brief Get a copy of the allocator
+   * @return The allocator used for the slots
+   */
+  [[nodiscard]] allocator_type get_allocator() const noexcept {
+    return alloc_;
+  }
+
+ private:
+  // Producer-private; tail mirrors tail_ so the producer never reads it back
+  struct alignas(detail::cache_line_size) producer_state {
+    size_type tail{0};
+    size_type head_cache{0};  ///< Slowest reader cursor seen last time
+    size_type live_from{0};   ///< First position whose slot holds an element
+  };
+
+  // One line per reader: head is written by its reader and, in gated mode,
+  // scanned by the producer only when head_cache says the buffer is full
+  struct alignas(detail::cache_line_size) reader_state {
+    std::atomic<size_type> head{0};
+    size_type tail_cache{0};
+    std::atomic<size_type> overruns{0};
+  };
+
+  [[nodiscard]] slot_type& slot(size_type pos) const noexcept {
+    return slots_[pos & index_mask_];
+  }
+
+  [[nodiscard]] size_type slowest_head(size_type tail) const noexcept {
+    size_type slowest = tail;
+    for (size_type i = 0; i < readers_count_; ++i) {
+      const auto head = readers_[i].head.load(std::memory_order_acquire);
+      slowest = tail - head > tail - slowest ? head : slowest;
+    }
+    return slowest;
+  }
+
+  size_type capacity_;       ///< Actual capacity (power of 2)
+  size_type index_mask_;     ///< Mask for fast modulo (capacity - 1)
+  size_type readers_count_;  ///< Number of reader cursors
+  [[no_unique_address]] Allocator alloc_;
+  slot_type* slots_;
+  std::unique_ptr<reader_state[]> readers_;
+
+  producer_state producer_;
+  alignas(detail::cache_line_size) std::atomic<size_type> tail_{0};
+};
+
+}  // namespace fadli
@@ -0,0 +1,286 @@
+/**
+ * @file ByteRingBuffer.hpp
+ * @brief A lock-free spsc ring buffer of variable-length byte records.
+ * @author Fadli Arsani <fadlialim0029@gmail.com>
+ * @version 1.0.0
+ *
+ * MIT License
+ *
+ * Copyright (c) 2025 Fadli Arsani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <span>
+
+#include "SPSCRingBuffer.hpp"
+
+namespace fadli {
+
+/**
+ * @brief Lock-free single-producer single-consumer ring of byte records
+ *
+ * Each record is a small header followed by its payload, stored contiguously
+ * and aligned to record_alignment. A record that would straddle the end of
+ * the buffer is preceded by a padding record filling the tail, so every
+ * payload handed out is a single contiguous span.
+ *
+ * @warning This class is NOT thread-safe for multiple producers or consumers.
+ * @code
+ * fadli::ByteRingBuffer q(1 << 20);
+ *
+ * // Producer thread
+ * auto buf = q.try_reserve(msg_size);
+ * if (buf.data()) {
+ *     encode(buf);
+ *     q.commit(msg_size);
+ * }
+ *
+ * // Consumer thread
+ * for (auto rec = q.front(); rec.data(); rec = q.front()) {
+ *     decode(rec);
+ *     q.pop();
+ * }
+ * @endcode
+ */
+class ByteRingBuffer {
+ public:
+  using size_type = std::size_t;
+
+  /// Alignment of every record header and payload
+  static constexpr size_type record_alignment = 8;
+
+ private:
+  struct record_header {
+    std::uint32_t size;     ///< Payload size in bytes
+    std::uint32_t padding;  ///< Non-zero if the record only skips to the end
+  };
+  static_assert(sizeof(record_header) == record_alignment);
+
+  static constexpr std::align_val_t buffer_alignment_{
+      detail::cache_line_size};
+
+  static constexpr size_type record_bytes(size_type payload) noexcept {
+    return (sizeof(record_header) + payload + record_alignment - 1) &
+           ~(record_alignment - 1);
+  }
+
+  size_type capacity_;    ///< Buffer size in bytes (power of 2)
+  size_type index_mask_;  ///< Mask for fast modulo (capacity - 1)
+  std::byte* buffer_;     ///< Dynamically allocated buffer
+
+  // Byte offsets increase monotonically and are masked on access.
+  // Separate cache lines to prevent false sharing between producer and consumer
+  alignas(detail::cache_line_size) std::atomic<size_type> head_{0};
+  alignas(detail::cache_line_size) std::atomic<size_type> tail_{0};
+  alignas(detail::cache_line_size) size_type head_cache_{0};
+  size_type reserved_start_{0};  ///< Producer: offset of the reserved record
+  size_type reserved_size_{0};   ///< Producer: payload bytes reserved
+  alignas(detail::cache_line_size) size_type tail_cache_{0};
+
+  [[nodiscard]] record_header* header_at(size_type offset) const noexcept {
+    return reinterpret_cast<record_header*>(buffer_ + (offset & index_mask_));
+  }
+
+ public:
+  /**
+   * @brief Constructs a ring buffer with the specified size
+   * @param capacity Desired size in bytes (will be rounded up to power of 2,
+   *        min 64); see max_record_size() for the largest record it accepts
+   * @throws std::bad_alloc If memory allocation fails
+   */
+  explicit ByteRingBuffer(size_type capacity)
+      : capacity_(detail::next_power_of_2(capacity > 64 ? capacity : 64)),
+        index_mask_(capacity_ - 1),
+        buffer_(static_cast<std::byte*>(
+            ::operator new(capacity_, buffer_alignment_))) {}
+
+  /**
+   * @brief Destructor
+   */
+  ~ByteRingBuffer() { ::operator delete(buffer_, buffer_alignment_); }
+
+  // Non-copyable and non-movable for safety
+  ByteRingBuffer(const ByteRingBuffer&) = delete;
+  ByteRingBuffer& operator=(const ByteRingBuffer&) = delete;
+  ByteRingBuffer(ByteRingBuffer&&) = delete;
+  ByteRingBuffer& operator=(ByteRingBuffer&&) = delete;
+
+  /**
+   * @brief Reserve a contiguous record for in-place writing
+   * @param size Payload size in bytes
+   * @return Writable span of exactly size bytes, or an empty span with a null
+   *         data() if there is not enough free space or size exceeds
+   *         max_record_size()
+   * @note This function should only be called from the producer thread
+   * @note The record is not visible to the consumer until commit() is called;
+   *       reserving again before that replaces the reservation
+   */
+  [[nodiscard]] std::span<std::byte> try_reserve(size_type size) noexcept {
+    // Checked before rounding, which would wrap for sizes near SIZE_MAX
+    if (size > max_record_size()) {
+      return {};
+    }
+    const auto current_tail = tail_.load(std::memory_order_relaxed);
+    const auto needed = record_bytes(size);
+    const auto offset = current_tail & index_mask_;
+    // Records never wrap: skip the rest of the buffer if this one won't fit
+    const auto skip = offset + needed > capacity_ ? capacity_ - offset : 0;
+    if (capacity_ - (current_tail - head_cache_) < skip + needed) {
+      head_cache_ = head_.load(std::memory_order_acquire);
+      if (capacity_ - (current_tail - head_cache_) < skip + needed) {
+        return {};
+      }
+    }
+
+    if (skip != 0) {
+      *header_at(current_tail) = {0, 1};
+    }
+    reserved_start_ = current_tail + skip;
+    reserved_size_ = size;
+    return {reinterpret_cast<std::byte*>(header_at(reserved_start_) + 1), size};
+  }
+
+  /**
+   * @brief Publish the record obtained from try_reserve()
+   * @param size Number of payload bytes actually written; may be less than
+   *        the reserved size, in which case the remainder is released
+   * @note This function should only be called from the producer thread
+   * @warning Calling commit() without a successful try_reserve() is undefined
+   *          behavior
+   */
+  void commit(size_type size) noexcept {
+    assert(size <= reserved_size_ && "commit() larger than the reservation");
+    *header_at(reserved_start_) = {static_cast<std::uint32_t>(size), 0};
+    tail_.store(reserved_start_ + record_bytes(size),
+                std::memory_order_release);
+    reserved_size_ = 0;
+  }
+
+  /**
+   * @brief Attempt to push a copy of a record
+   * @param bytes The payload to copy into the buffer
+   * @return true if the record was successfully added, false if buffer full
+   * @note This function should only be called from the producer thread
+   */
+  [[nodiscard]] bool try_push(std::span<const std::byte> bytes) noexcept {
+    const auto record = try_reserve(bytes.size());
+    if (record.data() == nullptr) {
+      return false;
+    }
+    std::memcpy(record.data(), bytes.data(), bytes.size());
+    commit(bytes.size());
+    return true;
+  }
+
+  /**
+   * @brief Get the front record without removing it
+   * @return Read-only span over the front payload, or an empty span with a
+   *         null data() if the buffer is empty
+   * @note This function should only be called from the consumer thread
+   * @note You must call pop() after processing the record; records with an
+   *       empty payload are returned as an empty span with non-null data()
+   */
+  [[nodiscard]] std::span<const std::byte> front() noexcept {
+    auto current_head = head_.load(std::memory_order_relaxed);
+
+    for (;;) {
+      if (current_head == tail_cache_) {
+        tail_cache_ = tail_.load(std::memory_order_acquire);
+        if (current_head == tail_cache_) {
+          return {};
+        }
+      }
+
+      const auto* header = header_at(current_head);
+      if (!header->padding) {
+        return {reinterpret_cast<const std::byte*>(header + 1), header->size};
+      }
+
+      // Release the padding straight away; the record follows at offset 0
+      current_head += capacity_ - (current_head & index_mask_);
+      head_.store(current_head, std::memory_order_release);
+    }
+  }
+
+  /**
+   * @brief Remove the front record
+   * @note This function should only be called from the consumer thread
+   * @warning Calling pop() without a successful front() is undefined behavior
+   */
+  void pop() noexcept {
+    const auto current_head = head_.load(std::memory_order_relaxed);
+    assert(current_head != tail_.load(std::memory_order_relaxed) &&
+           "pop() called on empty buffer");
+    const auto* header = header_at(current_head);
+    assert(!header->padding && "pop() called without front()");
+    head_.store(current_head + record_bytes(header->size),
+                std::memory_order_release);
+  }
+
+  /**
+   * @brief Check if the buffer appears empty
+   * @return true if the buffer appears empty at the time of the call
+   * @note This is an approximate check due to concurrent access. The state
+   *       may change immediately after this function returns.
+   */
+  [[nodiscard]] bool empty() const noexcept {
+    return head_.load(std::memory_order_relaxed) ==
+           tail_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Get the approximate number of bytes in use
+   * @return Bytes occupied by records, their headers and padding
+   * @note This is an approximate value due to concurrent access.
+   */
+  [[nodiscard]] size_type bytes_used() const noexcept {
+    const auto head = head_.load(std::memory_order_acquire);
+    const auto tail = tail_.load(std::memory_order_relaxed);
+    return std::min(tail - head, capacity_);
+  }
+
+  /**
+   * @brief Get the buffer size
+   * @return The total number of bytes in the internal buffer
+   */
+  [[nodiscard]] size_type capacity() const noexcept { return capacity_; }
+
+  /**
+   * @brief Get the largest payload a single record can carry
+   * @return Half of capacity() minus the record header, and at most what
+   *         the header's 32-bit length field can hold
+   * @note Records are capped at half the buffer so that, whatever the current
+   *       offset, a record plus the padding in front of it fits once drained
+   */
+  [[nodiscard]] size_type max_record_size() const noexcept {
+    return std::min<size_type>(capacity_ / 2 - sizeof(record_header),
+                               std::numeric_limits<std::uint32_t>::max());
+  }
+};
+
+}  // namespace fadli
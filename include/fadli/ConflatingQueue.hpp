@@ -0,0 +1,282 @@
+/**
+ * @file ConflatingQueue.hpp
+ * @brief A lock-free spsc queue that keeps only the latest value per key.
+ * @author Fadli Arsani <fadlialim0029@gmail.com>
+ * @version 1.0.0
+ *
+ * MIT License
+ *
+ * Copyright (c) 2025 Fadli Arsani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "SPSCRingBuffer.hpp"
+
+namespace fadli {
+
+/**
+ * @brief Lock-free single-producer single-consumer queue conflating values
+ *        by key
+ * @tparam Key The key type; copied once into the key's slot
+ * @tparam T The value type (trivially copyable)
+ * @tparam Hash Hash function for Key
+ * @tparam KeyEqual Equality for Key
+ *
+ * Each key owns a slot holding its latest value. A push for a key that is
+ * already pending overwrites the value in place; otherwise the slot id is
+ * appended to an SPSCRingBuffer of ids. The consumer therefore sees each
+ * pending key once, in order of first arrival, with its newest value.
+ *
+ * The value is guarded by a seqlock, whose sequence doubles as a version.
+ * The consumer clears pending before reading, so a push that races the
+ * read either lands in it or re-enqueues the key, and a re-enqueued key
+ * whose version was already delivered is skipped. The key-to-slot index
+ * is private to the producer.
+ * @warning This class is NOT thread-safe for multiple producers or consumers.
+ * @code
+ * fadli::ConflatingQueue<InstrumentId, Quote> q(4096);
+ *
+ * // Producer thread
+ * q.try_push(quote.instrument, quote);
+ *
+ * // Consumer thread
+ * q.poll([](InstrumentId id, const Quote& quote) { reprice(id, quote); });
+ * @endcode
+ */
+template <typename Key, typename T, typename Hash = std::hash<Key>,
+          typename KeyEqual = std::equal_to<Key>>
+class ConflatingQueue {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "ConflatingQueue requires a trivially copyable T");
+  static_assert(std::is_copy_constructible_v<Key>,
+                "Key must be copy constructible");
+
+ public:
+  using key_type = Key;
+  using value_type = T;
+  using size_type = std::size_t;
+
+  /**
+   * @brief Constructs a queue for a bounded number of distinct keys
+   * @param max_keys Number of distinct keys the queue can ever hold
+   * @param hash Hash function for Key
+   * @param equal Equality for Key
+   * @throws std::bad_alloc If memory allocation fails
+   */
+  explicit ConflatingQueue(size_type max_keys, const Hash& hash = Hash(),
+                           const KeyEqual& equal = KeyEqual())
+      : max_keys_(max_keys),
+        index_mask_(detail::next_power_of_2(2 * max_keys) - 1),
+        hash_(hash),
+        equal_(equal),
+        slots_(std::make_unique<slot[]>(max_keys)),
+        delivered_(std::make_unique<std::uint64_t[]>(max_keys)),
+        index_(std::make_unique<std::uint32_t[]>(index_mask_ + 1)),
+        ids_(max_keys) {
+    assert(max_keys < std::numeric_limits<std::uint32_t>::max() &&
+           "too many keys");
+  }
+
+  // Non-copyable and non-movable for safety
+  ConflatingQueue(const ConflatingQueue&) = delete;
+  ConflatingQueue& operator=(const ConflatingQueue&) = delete;
+  ConflatingQueue(ConflatingQueue&&) = delete;
+  ConflatingQueue& operator=(ConflatingQueue&&) = delete;
+
+  /**
+   * @brief Publish the latest value for a key
+   * @param key The key the value belongs to
+   * @param value The value, replacing any pending one for the same key
+   * @return true if the value was stored, false if key is new and
+   *         max_keys() distinct keys are already in use
+   * @note This function should only be called from the producer thread
+   */
+  [[nodiscard]] bool try_push(const Key& key, const T& value) {
+    const auto id = find_or_insert(key);
+    if (id == no_slot) {
+      return false;
+    }
+
+    slot& s = slots_[id];
+    const auto version = s.version.load(std::memory_order_relaxed);
+    s.version.store(version + 1, std::memory_order_relaxed);
+    s.value.store(value);
+    s.version.store(version + 2, std::memory_order_release);
+
+    if (!s.pending.exchange(true, std::memory_order_acq_rel)) {
+      // At most one id per key is ever queued, so this cannot fail
+      const bool pushed = ids_.try_push(id);
+      assert(pushed && "id ring overflow");
+      (void)pushed;
+    } else {
+      ++conflated_;
+    }
+    return true;
+  }
+
+  /**
+   * @brief Process pending keys in order of first arrival
+   * @param f Callable invoked as f(const Key&, const T&) with each key's
+   *        latest value
+   * @param max_batch Maximum number of keys to process
+   * @return Number of keys processed
+   * @note This function should only be called from the consumer thread
+   */
+  template <typename F>
+  size_type poll(F&& f, size_type max_batch =
+                            std::numeric_limits<size_type>::max()) {
+    size_type processed = 0;
+    while (processed < max_batch) {
+      // Pop before clearing pending, so a key never has two queued ids
+      const auto id = ids_.try_pop();
+      if (!id) {
+        break;
+      }
+      slot& s = slots_[*id];
+      const auto value = take(s, delivered_[*id]);
+      if (value) {
+        f(*s.key, *value);
+        ++processed;
+      }
+    }
+    return processed;
+  }
+
+  /**
+   * @brief Attempt to pop the oldest pending key with its latest value
+   * @return std::optional containing the key and value if successful,
+   *         std::nullopt if nothing is pending
+   * @note This function should only be called from the consumer thread
+   */
+  [[nodiscard]] std::optional<std::pair<Key, T>> try_pop() {
+    std::optional<std::pair<Key, T>> item;
+    poll([&](const Key& key, const T& value) { item.emplace(key, value); },
+         1);
+    return item;
+  }
+
+  /**
+   * @brief Check if no key appears to be pending
+   * @return true if nothing is pending at the time of the call
+   * @note This is an approximate check due to concurrent access.
+   */
+  [[nodiscard]] bool empty() const noexcept { return ids_.empty(); }
+
+  /**
+   * @brief Get the approximate number of pending keys
+   * @return The approximate number of keys waiting for the consumer
+   * @note This is an approximate value due to concurrent access.
+   */
+  [[nodiscard]] size_type size() const noexcept { return ids_.size(); }
+
+  /**
+   * @brief Get the number of pushes merged into a pending value
+   * @return Pushes that updated a key in place instead of enqueueing it
+   * @note This function should only be called from the producer thread
+   */
+  [[nodiscard]] size_type conflated() const noexcept { return conflated_; }
+
+  /**
+   * @brief Get the key limit
+   * @return The number of distinct keys the queue can hold
+   */
+  [[nodiscard]] size_type max_keys() const noexcept { return max_keys_; }
+
+ private:
+  static constexpr std::uint32_t no_slot =
+      std::numeric_limits<std::uint32_t>::max();
+
+  // version is the seqlock sequence: odd while the producer writes value.
+  // key is set once, before the slot id is first published.
+  struct alignas(detail::cache_line_size) slot {
+    std::atomic<std::uint64_t> version{0};
+    std::atomic<bool> pending{false};
+    detail::seqlock_cell<T> value;
+    std::optional<Key> key;
+  };
+
+  // Producer only: open addressing over slot id + 1, 0 meaning empty
+  [[nodiscard]] std::uint32_t find_or_insert(const Key& key) {
+    for (auto pos = hash_(key) & index_mask_;; pos = (pos + 1) & index_mask_) {
+      const auto entry = index_[pos];
+      if (entry == 0) {
+        if (used_ == max_keys_) {
+          return no_slot;
+        }
+        const auto id = static_cast<std::uint32_t>(used_++);
+        slots_[id].key.emplace(key);
+        index_[pos] = id + 1;
+        return id;
+      }
+      if (equal_(*slots_[entry - 1].key, key)) {
+        return entry - 1;
+      }
+    }
+  }
+
+  // Consumer only: claim the pending value, or nothing if this version was
+  // already delivered through an earlier, racing entry of the same key
+  [[nodiscard]] static std::optional<T> take(slot& s,
+                                             std::uint64_t& delivered) {
+    s.pending.exchange(false, std::memory_order_acq_rel);
+    for (;;) {
+      const auto version = s.version.load(std::memory_order_acquire);
+      if (version & 1) {
+        detail::cpu_relax();
+        continue;
+      }
+      const T value = s.value.load();
+      if (s.version.load(std::memory_order_relaxed) != version) {
+        continue;
+      }
+      if (version == delivered) {
+        return std::nullopt;
+      }
+      delivered = version;
+      return value;
+    }
+  }
+
+  size_type max_keys_;    ///< Number of slots
+  size_type index_mask_;  ///< Mask of the key index (2 * max_keys rounded)
+  size_type used_{0};     ///< Producer: slots handed out so far
+  size_type conflated_{0};  ///< Producer: pushes merged in place
+  [[no_unique_address]] Hash hash_;
+  [[no_unique_address]] KeyEqual equal_;
+  std::unique_ptr<slot[]> slots_;
+  std::unique_ptr<std::uint64_t[]> delivered_;  ///< Consumer: last versions
+  std::unique_ptr<std::uint32_t[]> index_;      ///< Producer: key to slot
+  SPSCRingBuffer<std::uint32_t> ids_;           ///< Pending slot ids
+};
+
+}  // namespace fadli
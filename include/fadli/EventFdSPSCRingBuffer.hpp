@@ -0,0 +1,294 @@
+/**
+ * @file EventFdSPSCRingBuffer.hpp
+ * @brief An spsc ring buffer whose consumer can wait in epoll on an eventfd.
+ * @author Fadli Arsani <fadlialim0029@gmail.com>
+ * @version 1.0.0
+ *
+ * MIT License
+ *
+ * Copyright (c) 2025 Fadli Arsani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include "SPSCRingBuffer.hpp"
+
+namespace fadli {
+
+/**
+ * @brief SPSCRingBuffer whose consumer sleeps in epoll/poll/select instead
+ *        of spinning
+ * @tparam T The type of elements stored in the ring buffer
+ * @tparam Allocator Allocator for the slot array
+ *
+ * The consumer registers fd() for reading alongside its sockets. When
+ * drain() empties the ring it arms a flag, and only the first push to find
+ * the flag armed writes the eventfd. A busy ring therefore costs the
+ * producer a fence and a load per push and no syscalls; the eventfd is
+ * written once per idle-to-busy transition of the consumer.
+ *
+ * The consumer arms and then re-checks the ring, and the producer pushes
+ * and then checks the flag, with a seq_cst fence between each write and the
+ * following read, so a push is never left unsignalled while the consumer
+ * waits. The flag starts armed, so the first push is always signalled.
+ * @warning This class is NOT thread-safe for multiple producers or consumers.
+ * @code
+ * fadli::EventFdSPSCRingBuffer<Order> q(4096);
+ * epoll_event ev{.events = EPOLLIN, .data = {.fd = q.fd()}};
+ * epoll_ctl(epfd, EPOLL_CTL_ADD, q.fd(), &ev);
+ *
+ * // Producer thread
+ * q.try_push(order);
+ *
+ * // Consumer's event loop, on EPOLLIN for q.fd()
+ * do {
+ *     q.drain([](Order& o) { handle(o); }, 256);
+ * } while (!q.armed());
+ * @endcode
+ */
+template <typename T, typename Allocator = AlignedAllocator<T>>
+class EventFdSPSCRingBuffer {
+ public:
+  using ring_type = SPSCRingBuffer<T, dynamic_capacity, Allocator>;
+  using value_type = T;
+  using size_type = std::size_t;
+
+  /**
+   * @brief Constructs a ring buffer and its eventfd
+   * @param capacity Desired capacity (will be rounded up to power of 2)
+   * @param alloc Allocator for the slot array
+   * @throws std::bad_alloc If memory allocation fails
+   * @throws std::system_error If the eventfd cannot be created
+   */
+  explicit EventFdSPSCRingBuffer(size_type capacity,
+                                 const Allocator& alloc = Allocator())
+      : ring_(capacity, alloc),
+        fd_(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) {
+    if (fd_ < 0) {
+      throw std::system_error(errno, std::generic_category(), "eventfd");
+    }
+  }
+
+  /**
+   * @brief Destructor
+   * @note Closes the eventfd; unregister it from any epoll set first
+   */
+  ~EventFdSPSCRingBuffer() { ::close(fd_); }
+
+  // Non-copyable and non-movable for safety
+  EventFdSPSCRingBuffer(const EventFdSPSCRingBuffer&) = delete;
+  EventFdSPSCRingBuffer& operator=(const EventFdSPSCRingBuffer&) = delete;
+  EventFdSPSCRingBuffer(EventFdSPSCRingBuffer&&) = delete;
+  EventFdSPSCRingBuffer& operator=(EventFdSPSCRingBuffer&&) = delete;
+
+  /**
+   * @brief Attempt to construct an element in place
+   * @param args Arguments forwarded to the constructor of T
+   * @return true if the element was successfully added, false if buffer full
+   * @note This function should only be called from the producer thread
+   * @note Writes the eventfd if the consumer has armed it
+   */
+  template <typename... Args>
+  [[nodiscard]] bool try_emplace(Args&&... args) noexcept(
+      std::is_nothrow_constructible_v<T, Args&&...>) {
+    if (!ring_.try_emplace(std::forward<Args>(args)...)) {
+      return false;
+    }
+    signal();
+    return true;
+  }
+
+  /**
+   * @brief Attempt to push an element (copy version)
+   * @param item The element to add to the buffer
+   * @return true if the element was successfully added, false if buffer full
+   * @note This function should only be called from the producer thread
+   */
+  [[nodiscard]] bool try_push(const T& item) noexcept(
+      std::is_nothrow_copy_constructible_v<T>) {
+    return try_emplace(item);
+  }
+
+  /**
+   * @brief Attempt to push an element (move version)
+   * @param item The element to move into the buffer
+   * @return true if the element was successfully added, false if buffer full
+   * @note This function should only be called from the producer thread
+   */
+  [[nodiscard]] bool try_push(T&& item) noexcept(
+      std::is_nothrow_move_constructible_v<T>) {
+    return try_emplace(std::move(item));
+  }
+
+  /**
+   * @brief Process elements in batches until the ring is empty, then arm
+   * @param f Callable invoked as f(T&) on each element, in FIFO order
+   * @param max_batch Maximum number of elements to process in this call
+   * @return Number of elements processed
+   * @note This function should only be called from the consumer thread
+   * @note Stopping at max_batch leaves the ring unarmed, so fd() will not
+   *       fire for what is left; check armed() and call again before waiting
+   */
+  template <typename F>
+  size_type drain(F&& f,
+                  size_type max_batch = std::numeric_limits<size_type>::max()) {
+    disarm();
+    size_type processed = 0;
+    while (processed < max_batch) {
+      const auto batch = ring_.front_n(max_batch - processed);
+      if (batch.empty()) {
+        if (arm()) {
+          break;
+        }
+        continue;
+      }
+      for (auto& item : batch.first) {
+        f(item);
+      }
+      for (auto& item : batch.second) {
+        f(item);
+      }
+      ring_.pop_n(batch.size());
+      processed += batch.size();
+    }
+    return processed;
+  }
+
+  /**
+   * @brief Attempt to pop an element
+   * @return std::optional containing the popped element if successful,
+   *         std::nullopt if buffer is empty
+   * @note This function should only be called from the consumer thread
+   * @note Does not arm; the consumer should finish with drain() before it
+   *       waits on fd()
+   */
+  [[nodiscard]] std::optional<T> try_pop() noexcept(
+      std::is_nothrow_move_constructible_v<T>) {
+    disarm();
+    return ring_.try_pop();
+  }
+
+  /**
+   * @brief Check whether the next push will write the eventfd
+   * @return true if the consumer may wait on fd() without missing anything
+   * @note This function should only be called from the consumer thread
+   */
+  [[nodiscard]] bool armed() const noexcept { return armed_by_consumer_; }
+
+  /**
+   * @brief Get the eventfd to register for reading
+   * @return A non-blocking eventfd, readable once a push follows arming
+   */
+  [[nodiscard]] int fd() const noexcept { return fd_; }
+
+  /**
+   * @brief Check if the buffer appears empty
+   * @return true if the buffer appears empty at the time of the call
+   * @note This is an approximate check due to concurrent access.
+   */
+  [[nodiscard]] bool empty() const noexcept { return ring_.empty(); }
+
+  /**
+   * @brief Get the approximate current size
+   * @return The approximate number of elements in the buffer
+   * @note This is an approximate value due to concurrent access.
+   */
+  [[nodiscard]] size_type size() const noexcept { return ring_.size(); }
+
+  /**
+   * @brief Get the maximum capacity
+   * @return The maximum number of elements this buffer can hold
+   */
+  [[nodiscard]] size_type capacity() const noexcept {
+    return ring_.capacity();
+  }
+
+ private:
+  // Producer: wake an armed consumer, once
+  void signal() noexcept {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (armed_.load(std::memory_order_relaxed) &&
+        armed_.exchange(false, std::memory_order_relaxed)) {
+      const std::uint64_t one = 1;
+      // Only fails with EAGAIN once the counter nears 2^64, still readable
+      [[maybe_unused]] const auto written = ::write(fd_, &one, sizeof(one));
+    }
+  }
+
+  // Consumer: returns true if the ring stayed empty after arming, so the
+  // caller may wait on fd()
+  bool arm() noexcept {
+    clear_event();
+    armed_.store(true, std::memory_order_relaxed);
+    armed_by_consumer_ = true;
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (ring_.empty()) {
+      return true;
+    }
+    disarm();
+    return false;
+  }
+
+  // Consumer: take the flag back; if the producer took it first, its write
+  // leaves the eventfd readable and has to be read off
+  void disarm() noexcept {
+    if (!armed_by_consumer_) {
+      return;
+    }
+    armed_by_consumer_ = false;
+    if (!armed_.exchange(false, std::memory_order_relaxed)) {
+      event_pending_ = true;
+      clear_event();
+    }
+  }
+
+  // The producer may not have written yet, so a read that finds nothing
+  // keeps event_pending_ and is retried before the next arm
+  void clear_event() noexcept {
+    if (event_pending_) {
+      std::uint64_t count;
+      event_pending_ = ::read(fd_, &count, sizeof(count)) != sizeof(count);
+    }
+  }
+
+  ring_type ring_;
+  int fd_;
+  bool armed_by_consumer_{true};  ///< Consumer: whether it last armed
+  bool event_pending_{false};     ///< Consumer: a signal is still unread
+
+  // Written by both sides, apart from both indices
+  alignas(detail::cache_line_size) std::atomic<bool> armed_{true};
+};
+
+}  // namespace fadli
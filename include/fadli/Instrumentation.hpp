@@ -0,0 +1,297 @@
+/**
+ * @file Instrumentation.hpp
+ * @brief Latency histogram and counters for SPSCRingBuffer instrumentation.
+ * @author Fadli Arsani <fadlialim0029@gmail.com>
+ * @version 1.0.0
+ *
+ * MIT License
+ *
+ * Copyright (c) 2025 Fadli Arsani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "SPSCRingBuffer.hpp"
+
+namespace fadli {
+
+/**
+ * @brief Timestamp source reading std::chrono::steady_clock, in nanoseconds
+ */
+struct SteadyClockTimestamp {
+  [[nodiscard]] static std::uint64_t now() noexcept {
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+  }
+};
+
+#if defined(__x86_64__) || defined(__i386__)
+/**
+ * @brief Timestamp source reading the time stamp counter, in cycles
+ * @note Only meaningful across cores on CPUs with an invariant TSC
+ */
+struct TscTimestamp {
+  [[nodiscard]] static std::uint64_t now() noexcept { return __rdtsc(); }
+};
+#endif
+
+/**
+ * @brief Single-writer log-linear histogram of 64-bit values
+ *
+ * Buckets follow the HdrHistogram layout: values below 32 are exact and every
+ * power-of-two range above is split into 32 linear sub-buckets, so recorded
+ * values keep about 3% relative precision over the full 64-bit range.
+ * Buckets are atomics updated with plain loads and stores by the one writer,
+ * so any thread may read while it records; totals seen by a concurrent reader
+ * are approximate.
+ */
+class LatencyHistogram {
+ public:
+  static constexpr unsigned precision_bits = 5;
+  static constexpr std::size_t sub_bucket_count = std::size_t{1}
+                                                  << precision_bits;
+  static constexpr std::size_t bucket_count =
+      sub_bucket_count * (64 - precision_bits + 1);
+
+  /**
+   * @brief Record one value
+   * @note This function should only be called from the owning thread
+   */
+  void record(std::uint64_t value) noexcept {
+    bump(buckets_[bucket_index(value)]);
+    bump(count_);
+    if (value > max_.load(std::memory_order_relaxed)) {
+      max_.store(value, std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * @brief Get the number of recorded values
+   */
+  [[nodiscard]] std::uint64_t count() const noexcept {
+    return count_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Get the largest recorded value
+   */
+  [[nodiscard]] std::uint64_t max() const noexcept {
+    return max_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Get the value at a percentile
+   * @param percentile Percentile in [0, 100]
+   * @return Upper bound of the bucket holding that percentile, or 0 if
+   *         nothing has been recorded
+   */
+  [[nodiscard]] std::uint64_t value_at_percentile(
+      double percentile) const noexcept {
+    std::uint64_t total = 0;
+    for (const auto& bucket : buckets_) {
+      total += bucket.load(std::memory_order_relaxed);
+    }
+    if (total == 0) {
+      return 0;
+    }
+    const auto clamped = percentile < 0 ? 0 : percentile > 100 ? 100
+                                                                : percentile;
+    auto target =
+        static_cast<std::uint64_t>(std::ceil(clamped / 100 * total));
+    target = target == 0 ? 1 : target;
+
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < bucket_count; ++i) {
+      seen += buckets_[i].load(std::memory_order_relaxed);
+      if (seen >= target) {
+        const auto upper = bucket_upper_bound(i);
+        return upper < max() ? upper : max();
+      }
+    }
+    return max();
+  }
+
+ private:
+  static void bump(std::atomic<std::uint64_t>& counter) noexcept {
+    counter.store(counter.load(std::memory_order_relaxed) + 1,
+                  std::memory_order_relaxed);
+  }
+
+  static constexpr std::size_t bucket_index(std::uint64_t value) noexcept {
+    if (value < sub_bucket_count) {
+      return static_cast<std::size_t>(value);
+    }
+    const unsigned magnitude = std::bit_width(value) - 1;
+    const unsigned shift = magnitude - precision_bits;
+    return sub_bucket_count * (shift + 1) +
+           static_cast<std::size_t>((value >> shift) - sub_bucket_count);
+  }
+
+  static constexpr std::uint64_t bucket_upper_bound(
+      std::size_t index) noexcept {
+    if (index < sub_bucket_count) {
+      return index;
+    }
+    const unsigned shift =
+        static_cast<unsigned>(index / sub_bucket_count) - 1;
+    const std::uint64_t lower = (sub_bucket_count + index % sub_bucket_count)
+                                << shift;
+    return lower + ((std::uint64_t{1} << shift) - 1);
+  }
+
+  std::atomic<std::uint64_t> count_{0};
+  std::atomic<std::uint64_t> max_{0};
+  std::atomic<std::uint64_t> buckets_[bucket_count] = {};
+};
+
+/**
+ * @brief Instrumentation policy measuring queue residency and cache misses
+ * @tparam Timestamp Source of timestamps (SteadyClockTimestamp, TscTimestamp
+ *         or any type with a static std::uint64_t now())
+ *
+ * The producer stamps every slot as it is published and the consumer records
+ * now - stamp as the slot is released (pop(), pop_n(), try_pop()), so the
+ * histogram holds enqueue-to-dequeue latency in Timestamp units. Stamps are
+ * ordinary memory ordered by the buffer's own release/acquire indices.
+ *
+ * Producer counters and consumer state sit on separate cache lines, and
+ * every counter has a single writer, so nothing here adds an RMW to the hot
+ * paths. All accessors may be called from any thread.
+ * @code
+ * struct Traits : fadli::SPSCRingBufferTraits {
+ *   using instrumentation = fadli::LatencyInstrumentation<>;
+ * };
+ * fadli::SPSCRingBuffer<Msg, 0, fadli::AlignedAllocator<Msg>, Traits> q(4096);
+ * // ...
+ * auto p99 = q.instrumentation().latency().value_at_percentile(99);
+ * @endcode
+ */
+template <typename Timestamp = SteadyClockTimestamp>
+class LatencyInstrumentation {
+ public:
+  /**
+   * @brief Constructs the policy for a buffer of capacity slots
+   * @throws std::bad_alloc If the timestamp array cannot be allocated
+   */
+  explicit LatencyInstrumentation(std::size_t capacity)
+      : index_mask_(capacity - 1),
+        stamps_(std::make_unique<std::uint64_t[]>(capacity)) {}
+
+  void on_publish(std::size_t first, std::size_t count) noexcept {
+    const auto now = Timestamp::now();
+    for (std::size_t i = 0; i < count; ++i) {
+      stamps_[(first + i) & index_mask_] = now;
+    }
+  }
+
+  void on_full() noexcept { bump(full_rejections_); }
+
+  void on_head_refresh() noexcept { bump(head_refreshes_); }
+
+  void on_tail_refresh(std::size_t occupancy) noexcept {
+    bump(tail_refreshes_);
+    if (occupancy > high_water_mark_.load(std::memory_order_relaxed)) {
+      high_water_mark_.store(occupancy, std::memory_order_relaxed);
+    }
+  }
+
+  void on_consume(std::size_t first, std::size_t count) noexcept {
+    const auto now = Timestamp::now();
+    for (std::size_t i = 0; i < count; ++i) {
+      const auto stamp = stamps_[(first + i) & index_mask_];
+      // Timestamps from different cores may be slightly out of step
+      latency_.record(now > stamp ? now - stamp : 0);
+    }
+  }
+
+  /**
+   * @brief Get the enqueue-to-dequeue latency histogram
+   */
+  [[nodiscard]] const LatencyHistogram& latency() const noexcept {
+    return latency_;
+  }
+
+  /**
+   * @brief Get the number of pushes rejected because the buffer was full
+   */
+  [[nodiscard]] std::uint64_t full_rejections() const noexcept {
+    return full_rejections_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Get the number of times the producer's head_cache_ went stale
+   */
+  [[nodiscard]] std::uint64_t head_refreshes() const noexcept {
+    return head_refreshes_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Get the number of times the consumer's tail_cache_ went stale
+   */
+  [[nodiscard]] std::uint64_t tail_refreshes() const noexcept {
+    return tail_refreshes_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Get the highest occupancy observed by the consumer
+   * @note Sampled whenever the consumer reloads the tail, which is when it
+   *       sees the backlog that built up since its previous reload
+   */
+  [[nodiscard]] std::size_t high_water_mark() const noexcept {
+    return high_water_mark_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  static void bump(std::atomic<std::uint64_t>& counter) noexcept {
+    counter.store(counter.load(std::memory_order_relaxed) + 1,
+                  std::memory_order_relaxed);
+  }
+
+  std::size_t index_mask_;
+  std::unique_ptr<std::uint64_t[]> stamps_;
+
+  // Producer-owned
+  alignas(detail::cache_line_size) std::atomic<std::uint64_t> full_rejections_{
+      0};
+  std::atomic<std::uint64_t> head_refreshes_{0};
+
+  // Consumer-owned
+  alignas(detail::cache_line_size) std::atomic<std::uint64_t> tail_refreshes_{
+      0};
+  std::atomic<std::size_t> high_water_mark_{0};
+  LatencyHistogram latency_;
+};
+
+}  // namespace fadli
@@ -0,0 +1,841 @@
+/**
+ * @file JournalRingBuffer.hpp
+ * @brief A spsc ring buffer whose slots are memory-mapped journal segments.
+ * @author Fadli Arsani <fadlialim0029@gmail.com>
+ * @version 1.0.0
+ *
+ * MIT License
+ *
+ * Copyright (c) 2025 Fadli Arsani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+
+#include "SPSCRingBuffer.hpp"
+
+namespace fadli {
+
+/**
+ * @brief How a JournalRingBuffer flushes a segment it is done with
+ */
+enum class JournalSync {
+  none,   ///< Leave write-back to the kernel
+  async,  ///< msync(MS_ASYNC): start write-back without waiting
+  sync,   ///< msync(MS_SYNC): wait until the segment is on disk
+};
+
+/**
+ * @brief Layout and durability options of a new JournalRingBuffer
+ */
+struct JournalOptions {
+  /// Elements per segment file (rounded up to power of 2); ignored when
+  /// reopening, where the journal's own value is used
+  std::size_t segment_capacity = std::size_t{1} << 20;
+  /// Segments mapped at once; the producer can run this many segments,
+  /// less the one being consumed, ahead of the consumer
+  std::size_t window = 4;
+  /// Applied to each segment when the consumer rolls past it
+  JournalSync sync = JournalSync::async;
+};
+
+namespace detail {
+
+/**
+ * @brief Contents of the journal's index file
+ *
+ * The live head and tail of the ring are kept here rather than in the
+ * process, so the journal resumes where it stopped after a restart and a
+ * JournalReader in another process sees the tail as it is published.
+ */
+struct journal_header {
+  // "fadliJRN" in ASCII
+  static constexpr std::uint64_t expected_magic = 0x6661646c694a524e;
+  static constexpr std::uint32_t current_version = 1;
+
+  std::atomic<std::uint64_t> magic;
+  std::uint32_t version;
+  std::uint32_t header_size;
+  std::uint64_t element_size;
+  std::uint64_t element_alignment;
+  std::uint64_t segment_capacity;  ///< Elements per segment (power of 2)
+
+  // Monotonic sequence numbers, on separate cache lines as in SPSCRingBuffer
+  alignas(cache_line_size) std::atomic<std::uint64_t> head;
+  alignas(cache_line_size) std::atomic<std::uint64_t> tail;
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+              "Journal indices require lock-free 64-bit atomics");
+
+[[noreturn]] inline void throw_errno(int error, const char* what) {
+  throw std::system_error(error, std::generic_category(), what);
+}
+
+inline std::string journal_index_path(const std::string& directory) {
+  return directory + "/index";
+}
+
+inline std::string journal_segment_path(const std::string& directory,
+                                        std::uint64_t segment) {
+  char name[32];
+  std::snprintf(name, sizeof(name), "/%020llu.seg",
+                static_cast<unsigned long long>(segment));
+  return directory + name;
+}
+
+// Maps size bytes of fd and closes it, whether or not the mapping succeeds
+inline void* map_file(int fd, std::size_t size, int prot, int flags = 0) {
+  void* p = ::mmap(nullptr, size, prot, MAP_SHARED | flags, fd, 0);
+  const int error = errno;
+  ::close(fd);
+  if (p == MAP_FAILED) {
+    throw_errno(error, "mmap");
+  }
+  return p;
+}
+
+// Checks the index against T; returns an error message or nullptr
+template <typename T>
+const char* validate_journal(const journal_header& header,
+                             std::size_t mapping_size) noexcept {
+  if (mapping_size < sizeof(journal_header) ||
+      header.magic.load(std::memory_order_acquire) !=
+          journal_header::expected_magic) {
+    return "journal is not initialized";
+  }
+  if (header.version != journal_header::current_version ||
+      header.header_size != sizeof(journal_header)) {
+    return "journal layout version mismatch";
+  }
+  if (header.element_size != sizeof(T) ||
+      header.element_alignment != alignof(T)) {
+    return "journal element type mismatch";
+  }
+  if (!std::has_single_bit(header.segment_capacity)) {
+    return "journal segment capacity is corrupt";
+  }
+  return nullptr;
+}
+
+}  // namespace detail
+
+/**
+ * @brief Single-producer single-consumer ring buffer that doubles as an
+ *        on-disk journal
+ * @tparam T The type of elements stored; must be trivially copyable since
+ *         the bytes are the file contents
+ *
+ * Element n is stored at offset n % segment_capacity of segment file
+ * n / segment_capacity in the journal directory, and the ring's slots are a
+ * window of JournalOptions::window such segments mapped into memory. The
+ * producer writes straight into the mapping, so capture costs no copy
+ * beyond the push itself, and the page cache writes it back.
+ *
+ * Slots are never reused: the producer may run ahead until the end of the
+ * window. When the consumer leaves a segment it rolls the window: the
+ * finished segment is msync'd per JournalOptions::sync and unmapped, and the
+ * next one is created, allocated with posix_fallocate and prefaulted, so
+ * neither a full disk nor a page fault of a new file lands on the producer.
+ *
+ * The head and tail live in the journal's index file. Reopening a directory
+ * resumes both, redelivering what was pushed but not popped, and
+ * JournalReader replays any range of sequence numbers, even while the
+ * journal is being written.
+ * @warning This class is NOT thread-safe for multiple producers or consumers,
+ *          and a directory must be opened by one JournalRingBuffer at a time.
+ * @code
+ * fadli::JournalRingBuffer<Tick> journal("/var/lib/ticks",
+ *                                        {.segment_capacity = 1 << 22});
+ *
+ * // Capture thread
+ * if (Tick* slot = journal.try_reserve()) {
+ *     decode(packet, *slot);
+ *     journal.commit();
+ * }
+ *
+ * // Consumer thread
+ * while (const Tick* tick = journal.front()) {
+ *     process(*tick);
+ *     journal.pop();
+ * }
+ * @endcode
+ */
+template <typename T>
+class JournalRingBuffer {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "T must be trivially copyable to be written to a journal");
+
+ public:
+  using value_type = T;
+  using size_type = std::size_t;
+
+  /**
+   * @brief Opens the journal in directory, creating it if needed
+   * @param directory Directory holding the index and segment files; it is
+   *        created if it does not exist
+   * @param options Segment size, window and durability; the segment size of
+   *        an existing journal is kept
+   * @throws std::system_error If a file cannot be created, sized or mapped
+   * @throws std::runtime_error If the existing index is not initialized or
+   *         was written for a different layout version or element type
+   */
+  explicit JournalRingBuffer(std::string directory,
+                             JournalOptions options = {})
+      : directory_(std::move(directory)),
+        window_(std::max<size_type>(options.window, 1)),
+        sync_(options.sync),
+        segments_(std::make_unique<T*[]>(window_)) {
+    if (::mkdir(directory_.c_str(), 0755) != 0 && errno != EEXIST) {
+      detail::throw_errno(errno, "mkdir");
+    }
+    open_index(options.segment_capacity);
+
+    segment_shift_ = std::countr_zero(header_->segment_capacity);
+    const auto head = header_->head.load(std::memory_order_relaxed);
+    const auto tail = header_->tail.load(std::memory_order_relaxed);
+    consumer_.head = head;
+    consumer_.tail_cache = tail;
+    producer_.tail = tail;
+
+    const auto first = head >> segment_shift_;
+    consumer_.mapped_end = first;
+    try {
+      for (; consumer_.mapped_end < first + window_; ++consumer_.mapped_end) {
+        segments_[consumer_.mapped_end % window_] =
+            map_segment(consumer_.mapped_end);
+      }
+    } catch (...) {
+      for (auto segment = first; segment < consumer_.mapped_end; ++segment) {
+        ::munmap(segments_[segment % window_], segment_bytes());
+      }
+      ::munmap(header_, sizeof(header_type));
+      throw;
+    }
+    consumer_.roll_at = (first + 1) << segment_shift_;
+    producer_.limit_cache = consumer_.mapped_end << segment_shift_;
+    limit_.store(producer_.limit_cache, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Destructor
+   * @note Flushes the mapped segments per JournalOptions::sync and unmaps
+   *       them; the files are kept
+   */
+  ~JournalRingBuffer() {
+    for (auto segment = consumer_.mapped_end - window_;
+         segment < consumer_.mapped_end; ++segment) {
+      retire(segments_[segment % window_]);
+    }
+    ::msync(header_, sizeof(header_type),
+            sync_ == JournalSync::sync ? MS_SYNC : MS_ASYNC);
+    ::munmap(header_, sizeof(header_type));
+  }
+
+  // Non-copyable and non-movable for safety
+  JournalRingBuffer(const JournalRingBuffer&) = delete;
+  JournalRingBuffer& operator=(const JournalRingBuffer&) = delete;
+  JournalRingBuffer(JournalRingBuffer&&) = delete;
+  JournalRingBuffer& operator=(JournalRingBuffer&&) = delete;
+
+  /**
+   * @brief Reserve the next slot for in-place writing
+   * @return Pointer into the mapped segment, or nullptr if the producer has
+   *         reached the end of the window
+   * @note This function should only be called from the producer thread
+   * @note The slot is not visible to the consumer until commit() is called
+   */
+  [[nodiscard]] T* try_reserve() noexcept {
+    const auto span = reserve_n(1);
+    return span.empty() ? nullptr : span.data();
+  }
+
+  /**
+   * @brief Publish the slot obtained from try_reserve()
+   * @note This function should only be called from the producer thread
+   */
+  void commit() noexcept { commit_n(1); }
+
+  /**
+   * @brief Reserve up to max_count slots for in-place writing
+   * @param max_count Maximum number of slots to expose
+   * @return Writable slots up to the end of the current segment, or empty if
+   *         the producer has reached the end of the window
+   * @note This function should only be called from the producer thread
+   * @note Call commit_n() with the number of slots actually written
+   */
+  [[nodiscard]] std::span<T> reserve_n(size_type max_count) noexcept {
+    return reserve_at(producer_.tail, max_count);
+  }
+
+  /**
+   * @brief Publish count slots obtained from reserve_n()
+   * @param count Number of slots written, at most the size reserved
+   * @note This function should only be called from the producer thread
+   */
+  void commit_n(size_type count) noexcept {
+    producer_.tail += count;
+    header_->tail.store(producer_.tail, std::memory_order_release);
+  }
+
+  /**
+   * @brief Attempt to push an element
+   * @param item The element to copy into the journal
+   * @return true if the element was added, false if the window is full
+   * @note This function should only be called from the producer thread
+   */
+  [[nodiscard]] bool try_push(const T& item) noexcept {
+    T* dst = try_reserve();
+    if (!dst) {
+      return false;
+    }
+    std::memcpy(static_cast<void*>(dst), &item, sizeof(T));
+    commit();
+    return true;
+  }
+
+  /**
+   * @brief Attempt to push a contiguous batch of elements with one publish
+   * @param items The elements to copy into the journal
+   * @return The number of elements pushed, which is less than items.size()
+   *         if the window fills up
+   * @note This function should only be called from the producer thread
+   */
+  [[nodiscard]] size_type try_push_n(std::span<const T> items) noexcept {
+    size_type pushed = 0;
+    // One copy per segment the batch spans; publish once at the end
+    while (pushed < items.size()) {
+      const auto slots =
+          reserve_at(producer_.tail + pushed, items.size() - pushed);
+      if (slots.empty()) {
+        break;
+      }
+      detail::copy_elements(slots.data(), items.data() + pushed,
+                            slots.size());
+      pushed += slots.size();
+    }
+    if (pushed != 0) {
+      commit_n(pushed);
+    }
+    return pushed;
+  }
+
+  /**
+   * @brief Get pointer to the front element without removing it
+   * @return Pointer into the mapped segment, or nullptr if nothing is
+   *         readable
+   * @note This function should only be called from the consumer thread
+   * @note You must call pop() after processing the element
+   */
+  [[nodiscard]] T* front() noexcept {
+    const auto span = front_n(1);
+    return span.empty() ? nullptr : span.data();
+  }
+
+  /**
+   * @brief Get the readable elements in the front segment
+   * @param max_count Maximum number of elements to expose
+   * @return The readable elements up to the end of the front segment, in
+   *         sequence order; empty if nothing is readable
+   * @note This function should only be called from the consumer thread
+   * @note You must call pop_n() after processing the elements
+   */
+  [[nodiscard]] std::span<T> front_n(size_type max_count) noexcept {
+    const auto head = consumer_.head;
+    if (consumer_.tail_cache - head < max_count) {
+      consumer_.tail_cache = header_->tail.load(std::memory_order_acquire);
+      if (head == consumer_.tail_cache) {
+        return {};
+      }
+    }
+    if (head >= consumer_.segment_end) {
+      consumer_.base = segments_[(head >> segment_shift_) % window_];
+      consumer_.segment_end = (head | segment_mask()) + 1;
+    }
+    const auto count = std::min<std::uint64_t>(
+        max_count, std::min(consumer_.segment_end, consumer_.tail_cache) -
+                       head);
+    return {consumer_.base + (head & segment_mask()),
+            static_cast<size_type>(count)};
+  }
+
+  /**
+   * @brief Remove the front element
+   * @note This function should only be called from the consumer thread
+   * @throws std::system_error If this completes a segment and the next one
+   *         cannot be created or mapped. The element is popped regardless
+   *         and the roll is retried on the next pop.
+   * @warning Calling pop() without a successful front() is undefined behavior
+   */
+  void pop() { pop_n(1); }
+
+  /**
+   * @brief Remove the count front elements with a single publish
+   * @param count Number of elements to remove
+   * @note This function should only be called from the consumer thread
+   * @throws std::system_error As pop()
+   * @warning count must not exceed the number of readable elements
+   */
+  void pop_n(size_type count) {
+    assert(count <= header_->tail.load(std::memory_order_relaxed) -
+                        consumer_.head &&
+           "pop_n() called with more elements than available");
+    consumer_.head += count;
+    header_->head.store(consumer_.head, std::memory_order_release);
+    if (consumer_.head >= consumer_.roll_at) {
+      roll();
+    }
+  }
+
+  /**
+   * @brief Attempt to pop an element
+   * @return std::optional containing the popped element if successful,
+   *         std::nullopt if nothing is readable
+   * @note This function should only be called from the consumer thread
+   * @throws std::system_error As pop()
+   */
+  [[nodiscard]] std::optional<T> try_pop() {
+    const T* item = front();
+    if (!item) {
+      return std::nullopt;
+    }
+    std::optional<T> result(*item);
+    pop();
+    return result;
+  }
+
+  /**
+   * @brief Write the mapped segments and the index to disk and wait
+   * @throws std::system_error If msync fails
+   * @note This function should only be called from the consumer thread
+   */
+  void sync() {
+    for (auto segment = consumer_.mapped_end - window_;
+         segment < consumer_.mapped_end; ++segment) {
+      if (::msync(segments_[segment % window_], segment_bytes(), MS_SYNC) !=
+          0) {
+        detail::throw_errno(errno, "msync");
+      }
+    }
+    if (::msync(header_, sizeof(header_type), MS_SYNC) != 0) {
+      detail::throw_errno(errno, "msync");
+    }
+  }
+
+  /**
+   * @brief Get the sequence number of the front element
+   * @note This function should only be called from the consumer thread
+   */
+  [[nodiscard]] std::uint64_t front_sequence() const noexcept {
+    return consumer_.head;
+  }
+
+  /**
+   * @brief Get the sequence number the next push will be given
+   * @note This function should only be called from the producer thread
+   */
+  [[nodiscard]] std::uint64_t next_sequence() const noexcept {
+    return producer_.tail;
+  }
+
+  /**
+   * @brief Check if nothing appears to be readable
+   * @return true if the ring appears empty at the time of the call
+   * @note This is an approximate check due to concurrent access.
+   */
+  [[nodiscard]] bool empty() const noexcept {
+    return header_->head.load(std::memory_order_relaxed) ==
+           header_->tail.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Get the approximate number of readable elements
+   * @note This is an approximate value due to concurrent access.
+   */
+  [[nodiscard]] size_type size() const noexcept {
+    const auto head = header_->head.load(std::memory_order_acquire);
+    const auto tail = header_->tail.load(std::memory_order_relaxed);
+    return static_cast<size_type>(std::min<std::uint64_t>(
+        tail - head, std::uint64_t{window_} << segment_shift_));
+  }
+
+  /**
+   * @brief Get the number of slots in the mapped window
+   * @return window * segment_capacity; the producer can be up to that many
+   *         elements ahead, less what the consumer has read of its segment
+   */
+  [[nodiscard]] size_type capacity() const noexcept {
+    return window_ << segment_shift_;
+  }
+
+  /**
+   * @brief Get the number of elements per segment file
+   */
+  [[nodiscard]] size_type segment_capacity() const noexcept {
+    return size_type{1} << segment_shift_;
+  }
+
+  /**
+   * @brief Get the journal directory
+   * @return The directory passed at construction
+   */
+  [[nodiscard]] const std::string& directory() const noexcept {
+    return directory_;
+  }
+
+ private:
+  using header_type = detail::journal_header;
+
+  struct alignas(detail::cache_line_size) producer_state {
+    std::uint64_t tail{0};         ///< Next sequence to write
+    std::uint64_t limit_cache{0};  ///< Last value of limit_ seen
+    std::uint64_t segment_end{0};  ///< End of the segment base points to
+    T* base{nullptr};              ///< Mapping of the tail's segment
+  };
+
+  struct alignas(detail::cache_line_size) consumer_state {
+    std::uint64_t head{0};         ///< Next sequence to read
+    std::uint64_t tail_cache{0};   ///< Last value of the tail seen
+    std::uint64_t segment_end{0};  ///< End of the segment base points to
+    T* base{nullptr};              ///< Mapping of the head's segment
+    std::uint64_t mapped_end{0};   ///< One past the last mapped segment
+    std::uint64_t roll_at{0};      ///< Head at which to roll the window
+  };
+
+  std::string directory_;
+  size_type window_;
+  JournalSync sync_;
+  header_type* header_{nullptr};
+  unsigned segment_shift_{0};
+  // Segment s is mapped at segments_[s % window_]; written by the consumer
+  // before the limit covering s is published
+  std::unique_ptr<T*[]> segments_;
+
+  producer_state producer_;
+  consumer_state consumer_;
+  // End of the mapped window, published by the consumer as it rolls
+  alignas(detail::cache_line_size) std::atomic<std::uint64_t> limit_{0};
+
+  [[nodiscard]] std::uint64_t segment_mask() const noexcept {
+    return (std::uint64_t{1} << segment_shift_) - 1;
+  }
+
+  [[nodiscard]] size_type segment_bytes() const noexcept {
+    return segment_capacity() * sizeof(T);
+  }
+
+  // Writable slots from sequence, at or past the tail, to the end of its
+  // segment or the window; producer_.tail is left untouched
+  [[nodiscard]] std::span<T> reserve_at(std::uint64_t sequence,
+                                        size_type max_count) noexcept {
+    if (sequence >= producer_.limit_cache) {
+      producer_.limit_cache = limit_.load(std::memory_order_acquire);
+      if (sequence >= producer_.limit_cache) {
+        return {};
+      }
+    }
+    if (sequence >= producer_.segment_end) {
+      // The consumer mapped this segment before publishing the limit
+      producer_.base = segments_[(sequence >> segment_shift_) % window_];
+      producer_.segment_end = (sequence | segment_mask()) + 1;
+    }
+    const auto count = std::min<std::uint64_t>(
+        max_count, std::min(producer_.segment_end, producer_.limit_cache) -
+                       sequence);
+    return {producer_.base + (sequence & segment_mask()),
+            static_cast<size_type>(count)};
+  }
+
+  void open_index(size_type segment_capacity) {
+    const auto path = detail::journal_index_path(directory_);
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    const bool created = fd >= 0;
+    if (!created) {
+      if (errno != EEXIST) {
+        detail::throw_errno(errno, "open");
+      }
+      fd = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+      if (fd < 0) {
+        detail::throw_errno(errno, "open");
+      }
+      struct stat st {};
+      if (::fstat(fd, &st) != 0 ||
+          static_cast<std::size_t>(st.st_size) < sizeof(header_type)) {
+        ::close(fd);
+        throw std::runtime_error("journal is not initialized");
+      }
+    } else if (::ftruncate(fd, sizeof(header_type)) != 0) {
+      const int error = errno;
+      ::close(fd);
+      ::unlink(path.c_str());
+      detail::throw_errno(error, "ftruncate");
+    }
+
+    header_ = static_cast<header_type*>(
+        detail::map_file(fd, sizeof(header_type), PROT_READ | PROT_WRITE));
+    if (created) {
+      header_ = std::construct_at(header_);
+      header_->version = header_type::current_version;
+      header_->header_size = sizeof(header_type);
+      header_->element_size = sizeof(T);
+      header_->element_alignment = alignof(T);
+      header_->segment_capacity = detail::next_power_of_2(segment_capacity);
+      header_->head.store(0, std::memory_order_relaxed);
+      header_->tail.store(0, std::memory_order_relaxed);
+      header_->magic.store(header_type::expected_magic,
+                           std::memory_order_release);
+    } else if (const char* error =
+                   detail::validate_journal<T>(*header_, sizeof(header_type))) {
+      ::munmap(header_, sizeof(header_type));
+      throw std::runtime_error(error);
+    }
+  }
+
+  // Opens, creating and allocating if needed, and prefaults a segment
+  [[nodiscard]] T* map_segment(std::uint64_t segment) {
+    const auto path = detail::journal_segment_path(directory_, segment);
+    const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+      detail::throw_errno(errno, "open");
+    }
+    // Reserve the blocks now: a full disk would otherwise surface as SIGBUS
+    // on the producer's store. Fall back where fallocate is unsupported.
+    const auto size = static_cast<off_t>(segment_bytes());
+    int error = ::posix_fallocate(fd, 0, size);
+    if ((error == EOPNOTSUPP || error == EINVAL) &&
+        ::ftruncate(fd, size) == 0) {
+      error = 0;
+    }
+    if (error != 0) {
+      ::close(fd);
+      detail::throw_errno(error, "posix_fallocate");
+    }
+    return static_cast<T*>(detail::map_file(fd, segment_bytes(),
+                                            PROT_READ | PROT_WRITE,
+                                            MAP_POPULATE));
+  }
+
+  void retire(T* mapping) noexcept {
+    if (sync_ != JournalSync::none) {
+      ::msync(mapping, segment_bytes(),
+              sync_ == JournalSync::sync ? MS_SYNC : MS_ASYNC);
+    }
+    ::munmap(mapping, segment_bytes());
+  }
+
+  // Map segments up to window_ past the head's, retiring consumed ones. Each
+  // step maps the new segment before touching the old, so a failure leaves
+  // the window as it was and the next pop retries.
+  void roll() {
+    const auto wanted = (consumer_.head >> segment_shift_) + window_;
+    while (consumer_.mapped_end < wanted) {
+      const auto segment = consumer_.mapped_end;
+      T* fresh = map_segment(segment);
+      T*& entry = segments_[segment % window_];
+      // The producer left this segment before the consumer did
+      retire(entry);
+      entry = fresh;
+      consumer_.mapped_end = segment + 1;
+      limit_.store(consumer_.mapped_end << segment_shift_,
+                   std::memory_order_release);
+    }
+    consumer_.roll_at = (consumer_.mapped_end - window_ + 1) << segment_shift_;
+  }
+};
+
+/**
+ * @brief Read-only view of a journal written by JournalRingBuffer
+ * @tparam T The element type the journal was written with
+ *
+ * Replays any range of sequence numbers from the segment files, from any
+ * thread or process, including while the journal is live: end_sequence()
+ * follows the producer's published tail. Segments are mapped read-only one
+ * at a time as the replay reaches them.
+ * @warning Each reader object must be used by one thread at a time.
+ * @code
+ * fadli::JournalReader<Tick> reader("/var/lib/ticks");
+ * auto next = reader.replay(from, [](const Tick& t) { rebuild(t); });
+ * @endcode
+ */
+template <typename T>
+class JournalReader {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "T must be trivially copyable to be read from a journal");
+
+ public:
+  using value_type = T;
+  using size_type = std::size_t;
+
+  /**
+   * @brief Opens the journal in directory for reading
+   * @param directory Directory passed to the JournalRingBuffer
+   * @throws std::system_error If the index cannot be opened or mapped
+   * @throws std::runtime_error If the index is not initialized or was
+   *         written for a different layout version or element type
+   */
+  explicit JournalReader(std::string directory)
+      : directory_(std::move(directory)) {
+    const auto path = detail::journal_index_path(directory_);
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      detail::throw_errno(errno, "open");
+    }
+    struct stat st {};
+    if (::fstat(fd, &st) != 0 ||
+        static_cast<std::size_t>(st.st_size) < sizeof(header_type)) {
+      ::close(fd);
+      throw std::runtime_error("journal is not initialized");
+    }
+    header_ = static_cast<const header_type*>(
+        detail::map_file(fd, sizeof(header_type), PROT_READ));
+    if (const char* error =
+            detail::validate_journal<T>(*header_, sizeof(header_type))) {
+      ::munmap(const_cast<header_type*>(header_), sizeof(header_type));
+      throw std::runtime_error(error);
+    }
+    segment_shift_ = std::countr_zero(header_->segment_capacity);
+  }
+
+  /**
+   * @brief Destructor
+   */
+  ~JournalReader() {
+    if (segment_) {
+      ::munmap(const_cast<T*>(segment_), segment_bytes());
+    }
+    ::munmap(const_cast<header_type*>(header_), sizeof(header_type));
+  }
+
+  // Non-copyable and non-movable for safety
+  JournalReader(const JournalReader&) = delete;
+  JournalReader& operator=(const JournalReader&) = delete;
+  JournalReader(JournalReader&&) = delete;
+  JournalReader& operator=(JournalReader&&) = delete;
+
+  /**
+   * @brief Get one past the last sequence number written
+   * @note Elements before it are complete; it advances as the producer
+   *       publishes
+   */
+  [[nodiscard]] std::uint64_t end_sequence() const noexcept {
+    return header_->tail.load(std::memory_order_acquire);
+  }
+
+  /**
+   * @brief Read one element
+   * @param sequence Sequence number of the element
+   * @return The element, or std::nullopt if it has not been written yet
+   * @throws std::system_error If its segment file cannot be opened or mapped
+   */
+  [[nodiscard]] std::optional<T> read(std::uint64_t sequence) {
+    if (sequence >= end_sequence()) {
+      return std::nullopt;
+    }
+    return at(sequence);
+  }
+
+  /**
+   * @brief Replay elements in sequence order
+   * @param from Sequence number to start at
+   * @param f Callable invoked as f(const T&) on each element
+   * @param max_count Maximum number of elements to replay
+   * @return The sequence number after the last element replayed, to pass as
+   *         from on the next call
+   * @throws std::system_error If a segment file cannot be opened or mapped
+   */
+  template <typename F>
+  std::uint64_t replay(std::uint64_t from, F&& f,
+                       std::uint64_t max_count =
+                           std::numeric_limits<std::uint64_t>::max()) {
+    const auto last = end_sequence();
+    if (from >= last) {
+      return from;
+    }
+    const auto end = from + std::min(max_count, last - from);
+    for (auto sequence = from; sequence < end; ++sequence) {
+      f(at(sequence));
+    }
+    return end;
+  }
+
+  /**
+   * @brief Get the number of elements per segment file
+   */
+  [[nodiscard]] size_type segment_capacity() const noexcept {
+    return size_type{1} << segment_shift_;
+  }
+
+ private:
+  using header_type = detail::journal_header;
+
+  std::string directory_;
+  const header_type* header_{nullptr};
+  unsigned segment_shift_{0};
+  const T* segment_{nullptr};  ///< Mapping of mapped_segment_
+  std::uint64_t mapped_segment_{0};
+
+  [[nodiscard]] size_type segment_bytes() const noexcept {
+    return segment_capacity() * sizeof(T);
+  }
+
+  [[nodiscard]] const T& at(std::uint64_t sequence) {
+    const auto segment = sequence >> segment_shift_;
+    if (!segment_ || segment != mapped_segment_) {
+      const auto path = detail::journal_segment_path(directory_, segment);
+      const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+      if (fd < 0) {
+        detail::throw_errno(errno, "open");
+      }
+      const auto* mapping =
+          static_cast<const T*>(detail::map_file(fd, segment_bytes(),
+                                                 PROT_READ));
+      if (segment_) {
+        ::munmap(const_cast<T*>(segment_), segment_bytes());
+      }
+      segment_ = mapping;
+      mapped_segment_ = segment;
+    }
+    return segment_[sequence & (segment_capacity() - 1)];
+  }
+};
+
+}  // namespace fadli
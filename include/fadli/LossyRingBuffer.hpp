@@ -0,0 +1,172 @@
+/**
+ * @file LossyRingBuffer.hpp
+ * @brief A lock-free spsc ring buffer that overwrites the oldest elements.
+ * @author Fadli Arsani <fadlialim0029@gmail.com>
+ * @version 1.0.0
+ *
+ * MIT License
+ *
+ * Copyright (c) 2025 Fadli Arsani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "BroadcastRingBuffer.hpp"
+
+namespace fadli {
+
+/**
+ * @brief Lock-free single-producer single-consumer ring that never blocks
+ *        the producer
+ * @tparam T The type of elements stored in the ring buffer (trivially
+ *         copyable)
+ * @tparam Allocator Allocator for the slots
+ *
+ * When the consumer is a full buffer behind, push() overwrites the oldest
+ * element instead of failing. Every slot carries a seqlock sequence, so the
+ * consumer detects both a lap and a copy torn by a concurrent write, skips
+ * to the oldest element still intact and counts the loss in overruns().
+ * This is the single-reader case of BroadcastRingBuffer in overwrite mode.
+ *
+ * Suited to telemetry and snapshots, where stale data is worth less than a
+ * producer that never stalls; try_pop_latest() serves consumers that only
+ * want the newest value.
+ * @warning This class is NOT thread-safe for multiple producers or consumers.
+ * @code
+ * fadli::LossyRingBuffer<TopOfBook> q(1024);
+ *
+ * // Producer thread
+ * q.push(tob);
+ *
+ * // Consumer thread
+ * if (auto t = q.try_pop_latest()) {
+ *     render(*t);
+ * }
+ * @endcode
+ */
+template <typename T, typename Allocator = AlignedAllocator<T>>
+class LossyRingBuffer {
+ public:
+  using value_type = T;
+  using size_type = std::size_t;
+  using allocator_type = Allocator;
+
+  /**
+   * @brief Constructs a ring buffer with the specified capacity
+   * @param capacity Desired capacity (will be rounded up to power of 2)
+   * @param alloc Allocator for the slots
+   * @throws std::bad_alloc If memory allocation fails
+   */
+  explicit LossyRingBuffer(size_type capacity,
+                           const Allocator& alloc = Allocator())
+      : ring_(capacity, 1, alloc) {}
+
+  /**
+   * @brief Push an element, overwriting the oldest one if the buffer is full
+   * @param item The element to add to the buffer
+   * @note This function should only be called from the producer thread
+   */
+  void push(const T& item) noexcept { ring_.push(item); }
+
+  /**
+   * @brief Construct an element and push it, overwriting the oldest one if
+   *        the buffer is full
+   * @param args Arguments forwarded to the constructor of T
+   * @note This function should only be called from the producer thread
+   */
+  template <typename... Args>
+  void emplace(Args&&... args) noexcept(
+      std::is_nothrow_constructible_v<T, Args&&...>) {
+    (void)ring_.try_emplace(std::forward<Args>(args)...);
+  }
+
+  /**
+   * @brief Attempt to pop the oldest element still intact
+   * @return std::optional containing the popped element if successful,
+   *         std::nullopt if buffer is empty
+   * @note This function should only be called from the consumer thread
+   * @note Elements overwritten before they could be read are skipped and
+   *       added to overruns()
+   */
+  [[nodiscard]] std::optional<T> try_pop() noexcept {
+    return ring_.try_pop(0);
+  }
+
+  /**
+   * @brief Pop the newest element, discarding everything older
+   * @return std::optional containing the newest element if successful,
+   *         std::nullopt if buffer is empty
+   * @note This function should only be called from the consumer thread
+   * @note Elements discarded on purpose are not added to overruns()
+   */
+  [[nodiscard]] std::optional<T> try_pop_latest() noexcept {
+    return ring_.try_pop_latest(0);
+  }
+
+  /**
+   * @brief Get the number of elements lost to the producer
+   * @return Elements overwritten before the consumer could read them
+   * @note Safe to call from any thread; the count only grows
+   */
+  [[nodiscard]] size_type overruns() const noexcept {
+    return ring_.overruns(0);
+  }
+
+  /**
+   * @brief Check if the buffer appears empty
+   * @return true if the buffer appears empty at the time of the call
+   * @note This is an approximate check due to concurrent access.
+   */
+  [[nodiscard]] bool empty() const noexcept { return ring_.empty(0); }
+
+  /**
+   * @brief Get the approximate current size
+   * @return The approximate number of unread elements, at most capacity()
+   * @note This is an approximate value due to concurrent access.
+   */
+  [[nodiscard]] size_type size() const noexcept { return ring_.size(0); }
+
+  /**
+   * @brief Get the maximum capacity
+   * @return The number of newest elements the buffer retains
+   */
+  [[nodiscard]] size_type capacity() const noexcept {
+    return ring_.capacity();
+  }
+
+  /**
+   * @brief Get a copy of the allocator
+   * @return The allocator used for the slots
+   */
+  [[nodiscard]] allocator_type get_allocator() const noexcept {
+    return ring_.get_allocator();
+  }
+
+ private:
+  BroadcastRingBuffer<T, BroadcastMode::overwrite, Allocator> ring_;
+};
+
+}  // namespace fadli
@@ -0,0 +1,356 @@
+/**
+ * @file MPMCRingBuffer.hpp
+ * @brief Lock-free bounded ring buffers with multiple producers or consumers.
+ * @author Fadli Arsani <fadlialim0029@gmail.com>
+ * @version 1.0.0
+ *
+ * MIT License
+ *
+ * Copyright (c) 2025 Fadli Arsani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <type_traits>
+
+#include "SPSCRingBuffer.hpp"
+
+namespace fadli {
+namespace detail {
+
+/**
+ * @brief A slot tagged with the position it is ready for
+ *
+ * sequence == pos means free for the push at pos, pos + 1 means holding the
+ * element pushed at pos, which the pop at pos turns into pos + capacity.
+ */
+template <typename T>
+struct sequenced_slot {
+  std::atomic<std::size_t> sequence;
+  alignas(T) std::byte storage[sizeof(T)];
+
+  [[nodiscard]] T* get() noexcept { return reinterpret_cast<T*>(storage); }
+};
+
+/**
+ * @brief Bounded ring buffer with per-slot sequence numbers (Vyukov)
+ * @tparam T The type of elements stored in the ring buffer
+ * @tparam MultiProducer Whether producers claim positions with a CAS
+ * @tparam MultiConsumer Whether consumers claim positions with a CAS
+ * @tparam Allocator Allocator for the slots, rebound to the slot type
+ *
+ * A side with a single thread advances its index with a plain store instead
+ * of a CAS, so MPSC and SPMC only pay for contention where it exists.
+ */
+template <typename T, bool MultiProducer, bool MultiConsumer,
+          typename Allocator>
+class sequenced_ring_buffer {
+  static_assert(std::is_move_constructible_v<T>,
+                "T must be move constructible");
+  static_assert(std::is_nothrow_destructible_v<T>,
+                "T must be nothrow destructible");
+  static_assert(std::is_same_v<typename Allocator::value_type, T>,
+                "Allocator::value_type must be T");
+
+  using slot_type = sequenced_slot<T>;
+  using alloc_traits = std::allocator_traits<Allocator>;
+  using slot_allocator =
+      typename alloc_traits::template rebind_alloc<slot_type>;
+  using slot_traits = std::allocator_traits<slot_allocator>;
+
+ public:
+  using value_type = T;
+  using size_type = std::size_t;
+  using allocator_type = Allocator;
+
+  /**
+   * @brief Constructs a ring buffer with the specified capacity
+   * @param capacity Desired capacity (will be rounded up to power of 2, min 2)
+   * @param alloc Allocator for the slots
+   * @throws std::bad_alloc If memory allocation fails
+   */
+  explicit sequenced_ring_buffer(size_type capacity,
+                                 const Allocator& alloc = Allocator())
+      : capacity_(next_power_of_2(capacity > 2 ? capacity : 2)),
+        index_mask_(capacity_ - 1),
+        alloc_(alloc) {
+    slot_allocator slots(alloc_);
+    slots_ = std::to_address(slot_traits::allocate(slots, capacity_));
+    for (size_type i = 0; i < capacity_; ++i) {
+      std::construct_at(&slots_[i].sequence, i);
+    }
+  }
+
+  /**
+   * @brief Destructor
+   * @note Destroys any elements still in the buffer
+   */
+  ~sequenced_ring_buffer() {
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      const auto tail = tail_.load(std::memory_order_relaxed);
+      for (auto head = head_.load(std::memory_order_relaxed); head != tail;
+           ++head) {
+        alloc_traits::destroy(alloc_, slot(head).get());
+      }
+    }
+    slot_allocator slots(alloc_);
+    slot_traits::deallocate(slots, slots_, capacity_);
+  }
+
+  // Non-copyable and non-movable for safety
+  sequenced_ring_buffer(const sequenced_ring_buffer&) = delete;
+  sequenced_ring_buffer& operator=(const sequenced_ring_buffer&) = delete;
+  sequenced_ring_buffer(sequenced_ring_buffer&&) = delete;
+  sequenced_ring_buffer& operator=(sequenced_ring_buffer&&) = delete;
+
+  /**
+   * @brief Attempt to construct an element in place
+   * @param args Arguments forwarded to the constructor of T
+   * @return true if the element was successfully added, false if buffer full
+   * @note Safe to call from several producer threads if MultiProducer
+   * @warning If the constructor of T throws, the claimed slot stays reserved
+   *          and the buffer can no longer be consumed past it
+   */
+  template <typename... Args>
+  [[nodiscard]] bool try_emplace(Args&&... args) noexcept(
+      std::is_nothrow_constructible_v<T, Args&&...>) {
+    auto pos = tail_.load(std::memory_order_relaxed);
+    slot_type* s;
+    for (;;) {
+      s = &slot(pos);
+      const auto sequence = s->sequence.load(std::memory_order_acquire);
+      const auto diff = static_cast<std::ptrdiff_t>(sequence - pos);
+      if (diff < 0) {
+        return false;  // The slot still holds the element from a lap ago
+      }
+      if constexpr (MultiProducer) {
+        if (diff == 0 &&
+            tail_.compare_exchange_weak(pos, pos + 1,
+                                        std::memory_order_relaxed)) {
+          break;
+        }
+        if (diff > 0) {
+          pos = tail_.load(std::memory_order_relaxed);
+        }
+      } else {
+        tail_.store(pos + 1, std::memory_order_relaxed);
+        break;
+      }
+    }
+
+    alloc_traits::construct(alloc_, s->get(), std::forward<Args>(args)...);
+    s->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Attempt to push an element (copy version)
+   * @param item The element to add to the buffer
+   * @return true if the element was successfully added, false if buffer full
+   */
+  [[nodiscard]] bool try_push(const T& item) noexcept(
+      std::is_nothrow_copy_constructible_v<T>) {
+    return try_emplace(item);
+  }
+
+  /**
+   * @brief Attempt to push an element (move version)
+   * @param item The element to move into the buffer
+   * @return true if the element was successfully added, false if buffer full
+   */
+  [[nodiscard]] bool try_push(T&& item) noexcept(
+      std::is_nothrow_move_constructible_v<T>) {
+    return try_emplace(std::move(item));
+  }
+
+  /**
+   * @brief Get pointer to front element without removing it
+   * @return Pointer to front element, or nullptr if buffer is empty
+   * @note Only available with a single consumer, from the consumer thread
+   * @note You must call pop() after processing the element
+   */
+  [[nodiscard]] T* front() noexcept
+    requires(!MultiConsumer)
+  {
+    const auto pos = head_.load(std::memory_order_relaxed);
+    slot_type& s = slot(pos);
+    if (s.sequence.load(std::memory_order_acquire) != pos + 1) {
+      return nullptr;
+    }
+    return s.get();
+  }
+
+  /**
+   * @brief Remove and destroy the front element
+   * @note Only available with a single consumer, from the consumer thread
+   * @warning Calling pop() without a successful front() is undefined behavior
+   */
+  void pop() noexcept
+    requires(!MultiConsumer)
+  {
+    const auto pos = head_.load(std::memory_order_relaxed);
+    slot_type& s = slot(pos);
+    assert(s.sequence.load(std::memory_order_relaxed) == pos + 1 &&
+           "pop() called on empty buffer");
+    alloc_traits::destroy(alloc_, s.get());
+    head_.store(pos + 1, std::memory_order_relaxed);
+    s.sequence.store(pos + capacity_, std::memory_order_release);
+  }
+
+  /**
+   * @brief Attempt to pop an element
+   * @return std::optional containing the popped element if successful,
+   *         std::nullopt if buffer is empty
+   * @note Safe to call from several consumer threads if MultiConsumer
+   */
+  [[nodiscard]] std::optional<T> try_pop() noexcept(
+      std::is_nothrow_move_constructible_v<T>) {
+    auto pos = head_.load(std::memory_order_relaxed);
+    slot_type* s;
+    for (;;) {
+      s = &slot(pos);
+      const auto sequence = s->sequence.load(std::memory_order_acquire);
+      const auto diff = static_cast<std::ptrdiff_t>(sequence - (pos + 1));
+      if (diff < 0) {
+        return std::nullopt;  // Not yet written for this lap
+      }
+      if constexpr (MultiConsumer) {
+        if (diff == 0 &&
+            head_.compare_exchange_weak(pos, pos + 1,
+                                        std::memory_order_relaxed)) {
+          break;
+        }
+        if (diff > 0) {
+          pos = head_.load(std::memory_order_relaxed);
+        }
+      } else {
+        head_.store(pos + 1, std::memory_order_relaxed);
+        break;
+      }
+    }
+
+    std::optional<T> item(std::move(*s->get()));
+    alloc_traits::destroy(alloc_, s->get());
+    s->sequence.store(pos + capacity_, std::memory_order_release);
+    return item;
+  }
+
+  /**
+   * @brief Check if the buffer appears empty
+   * @return true if the buffer appears empty at the time of the call
+   * @note This is an approximate check due to concurrent access.
+   */
+  [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+
+  /**
+   * @brief Get the approximate current size
+   * @return The approximate number of elements, including those whose push
+   *         or pop is still in progress
+   * @note This is an approximate value due to concurrent access.
+   */
+  [[nodiscard]] size_type size() const noexcept {
+    const auto head = head_.load(std::memory_order_acquire);
+    const auto tail = tail_.load(std::memory_order_relaxed);
+    const auto diff = static_cast<std::ptrdiff_t>(tail - head);
+    return diff <= 0 ? 0
+                     : std::min(static_cast<size_type>(diff), capacity_);
+  }
+
+  /**
+   * @brief Get the maximum capacity
+   * @return The maximum number of elements this buffer can hold
+   */
+  [[nodiscard]] size_type capacity() const noexcept { return capacity_; }
+
+  /**
+   * @brief Get a copy of the allocator
+   * @return The allocator used for the slots
+   */
+  [[nodiscard]] allocator_type get_allocator() const noexcept {
+    return alloc_;
+  }
+
+ private:
+  [[nodiscard]] slot_type& slot(size_type pos) const noexcept {
+    return slots_[pos & index_mask_];
+  }
+
+  size_type capacity_;    ///< Actual capacity (power of 2)
+  size_type index_mask_;  ///< Mask for fast modulo (capacity - 1)
+  [[no_unique_address]] Allocator alloc_;
+  slot_type* slots_;
+
+  // Separate cache lines to prevent false sharing between producer and consumer
+  alignas(cache_line_size) std::atomic<size_type> tail_{0};
+  alignas(cache_line_size) std::atomic<size_type> head_{0};
+};
+
+}  // namespace detail
+
+/**
+ * @brief Lock-free multi-producer single-consumer ring buffer
+ * @tparam T The type of elements stored in the ring buffer
+ * @tparam Allocator Allocator for the slots
+ * @note try_emplace()/try_push() may be called from any number of threads;
+ *       front()/pop()/try_pop() only from the one consumer thread
+ * @code
+ * fadli::MPSCRingBuffer<Event> q(4096);
+ *
+ * // Any producer thread
+ * while (!q.try_push(event));
+ *
+ * // Consumer thread
+ * while (auto* e = q.front()) {
+ *     handle(*e);
+ *     q.pop();
+ * }
+ * @endcode
+ */
+template <typename T, typename Allocator = AlignedAllocator<T>>
+using MPSCRingBuffer = detail::sequenced_ring_buffer<T, true, false, Allocator>;
+
+/**
+ * @brief Lock-free single-producer multi-consumer ring buffer
+ * @tparam T The type of elements stored in the ring buffer
+ * @tparam Allocator Allocator for the slots
+ * @note try_pop() may be called from any number of threads; front()/pop()
+ *       are not available since another consumer could take the element
+ */
+template <typename T, typename Allocator = AlignedAllocator<T>>
+using SPMCRingBuffer = detail::sequenced_ring_buffer<T, false, true, Allocator>;
+
+/**
+ * @brief Lock-free bounded multi-producer multi-consumer ring buffer
+ * @tparam T The type of elements stored in the ring buffer
+ * @tparam Allocator Allocator for the slots
+ * @note Each slot carries a sequence number, so producers and consumers only
+ *       contend on their own index and never on each other's
+ */
+template <typename T, typename Allocator = AlignedAllocator<T>>
+using MPMCRingBuffer = detail::sequenced_ring_buffer<T, true, true, Allocator>;
+
+}  // namespace fadli
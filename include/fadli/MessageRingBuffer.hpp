@@ -0,0 +1,315 @@
+/**
+ * @file MessageRingBuffer.hpp
+ * @brief A lock-free spsc ring buffer of heterogeneous typed messages.
+ * @author Fadli Arsani <fadlialim0029@gmail.com>
+ * @version 1.0.0
+ *
+ * MIT License
+ *
+ * Copyright (c) 2025 Fadli Arsani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "ByteRingBuffer.hpp"
+
+namespace fadli {
+
+namespace detail {
+
+// Position of M in Ms..., or sizeof...(Ms) if absent
+template <typename M, typename... Ms>
+constexpr std::size_t message_index() noexcept {
+  std::size_t index = 0;
+  const bool found = ((std::is_same_v<M, Ms> ? true : (++index, false)) || ...);
+  return found ? index : sizeof...(Ms);
+}
+
+// True if each of Ms... is found at its own position, i.e. none repeats
+template <typename... Ms>
+constexpr bool distinct_messages() noexcept {
+  return []<std::size_t... I>(std::index_sequence<I...>) {
+    return ((message_index<Ms, Ms...>() == I) && ...);
+  }(std::index_sequence_for<Ms...>{});
+}
+
+}  // namespace detail
+
+/**
+ * @brief Lock-free single-producer single-consumer ring of messages of
+ *        several types
+ * @tparam Msgs The message types the ring carries, each listed once
+ *
+ * Each message is a ByteRingBuffer record holding a type tag followed by the
+ * object, constructed in place by the producer and used in place by the
+ * consumer, so a message takes its own size rather than the largest
+ * alternative's, and neither side copies it. The consumer dispatches on the
+ * tag through a table of functions, one per message type, generated at
+ * compile time for each handler; after the handler returns the message is
+ * destroyed and its bytes released.
+ *
+ * Unlike std::variant in an SPSCRingBuffer, there is no slot per message:
+ * capacity is in bytes, and how many messages fit depends on their sizes.
+ * @warning This class is NOT thread-safe for multiple producers or consumers.
+ * @code
+ * fadli::MessageRingBuffer<Order, Cancel, Heartbeat> bus(1 << 20);
+ *
+ * // Producer thread
+ * bus.try_emplace<Order>(id, price, qty);
+ * bus.try_push(Heartbeat{now});
+ *
+ * // Consumer thread
+ * bus.drain(overloaded{
+ *     [](Order& o) { book.add(o); },
+ *     [](Cancel& c) { book.cancel(c.id); },
+ *     [](Heartbeat&) {},
+ * });
+ * @endcode
+ */
+template <typename... Msgs>
+class MessageRingBuffer {
+  static_assert(sizeof...(Msgs) != 0, "MessageRingBuffer needs a message type");
+  static_assert(sizeof...(Msgs) <= std::numeric_limits<std::uint16_t>::max(),
+                "Too many message types for the 16-bit tag");
+  static_assert((std::is_object_v<Msgs> && ...) &&
+                    ((!std::is_const_v<Msgs> && !std::is_volatile_v<Msgs>) &&
+                     ...),
+                "Messages must be cv-unqualified object types");
+  static_assert((std::is_nothrow_destructible_v<Msgs> && ...),
+                "Messages must be nothrow destructible");
+  static_assert(detail::distinct_messages<Msgs...>(),
+                "Each message type must be listed once");
+
+ public:
+  using size_type = std::size_t;
+  /// Type tag stored in front of each message: its index in Msgs
+  using tag_type = std::conditional_t<(sizeof...(Msgs) <= 256), std::uint8_t,
+                                      std::uint16_t>;
+
+  /// Whether M is one of the message types
+  template <typename M>
+  static constexpr bool carries =
+      detail::message_index<M, Msgs...>() != sizeof...(Msgs);
+
+ private:
+  static constexpr size_type record_alignment =
+      ByteRingBuffer::record_alignment;
+
+  // Records start record_alignment-aligned, so up to that alignment M sits at
+  // a fixed offset behind the tag; beyond it the offset depends on where the
+  // record landed, and this is the most it can be
+  template <typename M>
+  static constexpr size_type max_offset =
+      alignof(M) <= record_alignment
+          ? (sizeof(tag_type) + alignof(M) - 1) & ~(alignof(M) - 1)
+          : alignof(M);
+
+  template <typename M>
+  static constexpr size_type record_size = max_offset<M> + sizeof(M);
+
+  static constexpr size_type largest_record = std::max({record_size<Msgs>...});
+
+  template <typename M>
+  [[nodiscard]] static std::byte* object_at(std::byte* record) noexcept {
+    if constexpr (alignof(M) <= record_alignment) {
+      return record + max_offset<M>;
+    } else {
+      const auto address =
+          reinterpret_cast<std::uintptr_t>(record) + sizeof(tag_type);
+      const auto aligned = (address + alignof(M) - 1) & ~(alignof(M) - 1);
+      return record + (aligned - reinterpret_cast<std::uintptr_t>(record));
+    }
+  }
+
+  template <typename M, typename F>
+  static void dispatch(std::byte* record, F& f) {
+    M* message = std::launder(reinterpret_cast<M*>(object_at<M>(record)));
+    f(*message);
+    std::destroy_at(message);
+  }
+
+  // One entry per message type, indexed by tag
+  template <typename F>
+  static constexpr std::array<void (*)(std::byte*, F&), sizeof...(Msgs)>
+      dispatch_table{&dispatch<Msgs, F>...};
+
+  ByteRingBuffer bytes_;
+
+ public:
+  /**
+   * @brief Constructs a ring buffer with the specified size
+   * @param capacity Desired size in bytes; rounded up to a power of 2 and to
+   *        at least twice the largest message, so every type always fits
+   * @throws std::bad_alloc If memory allocation fails
+   */
+  explicit MessageRingBuffer(size_type capacity)
+      // ByteRingBuffer caps payloads at half its size less the header
+      : bytes_(std::max(capacity, 2 * (largest_record + record_alignment))) {}
+
+  /**
+   * @brief Destructor
+   * @note Destroys any messages still in the buffer
+   */
+  ~MessageRingBuffer() {
+    drain([](auto&) noexcept {});
+  }
+
+  // Non-copyable and non-movable for safety
+  MessageRingBuffer(const MessageRingBuffer&) = delete;
+  MessageRingBuffer& operator=(const MessageRingBuffer&) = delete;
+  MessageRingBuffer(MessageRingBuffer&&) = delete;
+  MessageRingBuffer& operator=(MessageRingBuffer&&) = delete;
+
+  /**
+   * @brief Attempt to construct a message in place
+   * @tparam M The message type, one of Msgs
+   * @param args Arguments forwarded to the constructor of M
+   * @return true if the message was added, false if there is not enough
+   *         free space
+   * @note This function should only be called from the producer thread
+   * @note If the constructor throws, nothing is published
+   */
+  template <typename M, typename... Args>
+    requires(carries<M> && std::constructible_from<M, Args&&...>)
+  [[nodiscard]] bool try_emplace(Args&&... args) noexcept(
+      std::is_nothrow_constructible_v<M, Args&&...>) {
+    const auto record = bytes_.try_reserve(record_size<M>);
+    if (record.data() == nullptr) {
+      return false;
+    }
+    std::byte* object = object_at<M>(record.data());
+    std::construct_at(reinterpret_cast<M*>(object),
+                      std::forward<Args>(args)...);
+    constexpr auto tag =
+        static_cast<tag_type>(detail::message_index<M, Msgs...>());
+    std::memcpy(record.data(), &tag, sizeof(tag));
+    bytes_.commit(static_cast<size_type>(object - record.data()) + sizeof(M));
+    return true;
+  }
+
+  /**
+   * @brief Attempt to push a message
+   * @param message The message to copy or move into the buffer
+   * @return true if the message was added, false if there is not enough
+   *         free space
+   * @note This function should only be called from the producer thread
+   */
+  template <typename M>
+    requires carries<std::remove_cvref_t<M>>
+  [[nodiscard]] bool try_push(M&& message) noexcept(
+      std::is_nothrow_constructible_v<std::remove_cvref_t<M>, M&&>) {
+    return try_emplace<std::remove_cvref_t<M>>(std::forward<M>(message));
+  }
+
+  /**
+   * @brief Attempt to consume the front message
+   * @param f Handler invocable with an lvalue of every message type, e.g. a
+   *        generic lambda or an overload set
+   * @return true if a message was handled, false if the buffer is empty
+   * @note This function should only be called from the consumer thread
+   * @note The message is destroyed and released after f returns, so f may
+   *       move from it. If f throws, the message stays at the front.
+   */
+  template <typename F>
+    requires(std::invocable<F&, Msgs&> && ...)
+  bool try_consume(F&& f) {
+    const auto record = bytes_.front();
+    if (record.data() == nullptr) {
+      return false;
+    }
+    // front() hands out const bytes; the consumer owns the record until pop()
+    auto* bytes = const_cast<std::byte*>(record.data());
+    tag_type tag;
+    std::memcpy(&tag, bytes, sizeof(tag));
+    assert(tag < sizeof...(Msgs) && "corrupt message tag");
+    dispatch_table<F>[tag](bytes, f);
+    bytes_.pop();
+    return true;
+  }
+
+  /**
+   * @brief Consume messages until the buffer is empty
+   * @param f Handler as for try_consume()
+   * @param max_count Maximum number of messages to consume
+   * @return The number of messages handled
+   * @note This function should only be called from the consumer thread
+   */
+  template <typename F>
+    requires(std::invocable<F&, Msgs&> && ...)
+  size_type drain(F&& f,
+                  size_type max_count = std::numeric_limits<size_type>::max()) {
+    size_type count = 0;
+    while (count < max_count && try_consume(f)) {
+      ++count;
+    }
+    return count;
+  }
+
+  /**
+   * @brief Check if the buffer appears empty
+   * @return true if the buffer appears empty at the time of the call
+   * @note This is an approximate check due to concurrent access.
+   */
+  [[nodiscard]] bool empty() const noexcept { return bytes_.empty(); }
+
+  /**
+   * @brief Get the approximate number of bytes in use
+   * @return Bytes occupied by messages, their tags and record headers
+   * @note This is an approximate value due to concurrent access.
+   */
+  [[nodiscard]] size_type bytes_used() const noexcept {
+    return bytes_.bytes_used();
+  }
+
+  /**
+   * @brief Get the buffer size
+   * @return The total number of bytes in the internal buffer
+   */
+  [[nodiscard]] size_type capacity() const noexcept {
+    return bytes_.capacity();
+  }
+
+  /**
+   * @brief Get the bytes a message of type M takes in the buffer
+   * @return Payload reserved for M, tag and alignment included, excluding the
+   *         8-byte record header
+   */
+  template <typename M>
+    requires carries<M>
+  [[nodiscard]] static constexpr size_type message_size() noexcept {
+    return record_size<M>;
+  }
+};
+
+}  // namespace fadli
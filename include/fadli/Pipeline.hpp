@@ -0,0 +1,605 @@
+/**
+ * @file Pipeline.hpp
+ * @brief Multi-stage pipelines of pinned threads joined by spsc ring buffers.
+ * @author Fadli Arsani <fadlialim0029@gmail.com>
+ * @version 1.0.0
+ *
+ * MIT License
+ *
+ * Copyright (c) 2025 Fadli Arsani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "Instrumentation.hpp"
+#include "SPSCRingBuffer.hpp"
+
+namespace fadli {
+
+/**
+ * @brief Default traits of the rings between pipeline stages: latency
+ *        instrumentation, so every stage reports its input queue residency
+ */
+struct PipelineTraits : SPSCRingBufferTraits {
+  using instrumentation = LatencyInstrumentation<>;
+};
+
+/**
+ * @brief Per-stage settings for Pipeline
+ */
+struct StageOptions {
+  std::string name;               ///< Label reported in StageStats
+  int cpu = -1;                   ///< CPU to pin the stage thread to, or -1
+  std::size_t max_batch = 64;     ///< Most elements taken per input poll
+  std::size_t capacity = 0;       ///< Output ring capacity; 0 for default
+};
+
+/**
+ * @brief Snapshot of one stage's counters
+ */
+struct StageStats {
+  std::string name;
+  int cpu;
+  bool pinned;               ///< Whether pinning to cpu succeeded
+  std::uint64_t processed;   ///< Input elements consumed
+  std::uint64_t batches;     ///< Non-empty input polls
+  std::uint64_t idle_polls;  ///< Polls that found the input empty
+  std::uint64_t stalls;      ///< Polls that found the output full
+};
+
+namespace detail {
+
+// Pins the calling thread; false where unsupported, out of range or refused
+inline bool pin_current_thread(int cpu) noexcept {
+#ifdef __linux__
+  if (cpu < 0 || cpu >= CPU_SETSIZE) {
+    return false;
+  }
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+  (void)cpu;
+  return false;
+#endif
+}
+
+template <typename T>
+struct is_optional : std::false_type {};
+template <typename T>
+struct is_optional<std::optional<T>> : std::true_type {};
+
+// A stage returning std::optional<U> emits U, dropping elements on nullopt
+template <typename R>
+struct stage_output {
+  using type = R;
+};
+template <typename U>
+struct stage_output<std::optional<U>> {
+  using type = U;
+};
+
+template <typename T, typename Traits>
+using pipeline_ring = SPSCRingBuffer<T, dynamic_capacity, AlignedAllocator<T>,
+                                     Traits>;
+
+// The sink has no output ring
+template <typename Out, typename Traits>
+struct stage_output_ring {
+  using type = std::unique_ptr<pipeline_ring<Out, Traits>>;
+};
+template <typename Traits>
+struct stage_output_ring<void, Traits> {
+  using type = std::nullptr_t;
+};
+
+template <typename Traits>
+class pipeline_stage_base {
+ public:
+  using instrumentation_type = typename Traits::instrumentation;
+
+  explicit pipeline_stage_base(StageOptions options)
+      : options_(std::move(options)) {}
+  virtual ~pipeline_stage_base() = default;
+
+  virtual void run() = 0;
+  [[nodiscard]] virtual const instrumentation_type& input_instrumentation()
+      const noexcept = 0;
+
+  [[nodiscard]] StageStats stats() const {
+    return {options_.name,
+            options_.cpu,
+            pinned_.load(std::memory_order_relaxed),
+            processed_.load(std::memory_order_relaxed),
+            batches_.load(std::memory_order_relaxed),
+            idle_polls_.load(std::memory_order_relaxed),
+            stalls_.load(std::memory_order_relaxed)};
+  }
+
+  [[nodiscard]] const std::atomic<bool>& done() const noexcept {
+    return done_;
+  }
+
+  // Only read once the thread has been joined
+  [[nodiscard]] std::exception_ptr error() const noexcept { return error_; }
+
+ protected:
+  static void bump(std::atomic<std::uint64_t>& counter,
+                   std::uint64_t by = 1) noexcept {
+    counter.store(counter.load(std::memory_order_relaxed) + by,
+                  std::memory_order_relaxed);
+  }
+
+  StageOptions options_;
+  // Written by the stage thread only, read by stats() from anywhere
+  alignas(cache_line_size) std::atomic<bool> pinned_{false};
+  std::atomic<std::uint64_t> processed_{0};
+  std::atomic<std::uint64_t> batches_{0};
+  std::atomic<std::uint64_t> idle_polls_{0};
+  std::atomic<std::uint64_t> stalls_{0};
+  std::atomic<bool> done_{false};  ///< Set once the thread has drained out
+  std::exception_ptr error_;        ///< First exception thrown by the stage
+};
+
+/**
+ * @brief One stage: drains In from its input ring through F into its own
+ *        output ring, or into nothing when Out is void (the sink)
+ *
+ * Each poll takes up to max_batch inputs with front_n(), reserves as many
+ * output slots with reserve_n(), constructs results in place and publishes
+ * them with a single commit_n() before releasing the inputs with pop_n().
+ * The stage exits once upstream is done and its input is drained.
+ *
+ * If F throws, the outputs already constructed are still committed and the
+ * exception is kept for Pipeline::stop(). The stage then discards its input
+ * without calling F, so upstream never stalls behind it.
+ */
+template <typename In, typename Out, typename F, typename Traits>
+class pipeline_stage final : public pipeline_stage_base<Traits> {
+  using base = pipeline_stage_base<Traits>;
+  using result_type = std::invoke_result_t<F&, In&>;
+
+ public:
+  using input_ring = pipeline_ring<In, Traits>;
+
+  pipeline_stage(F f, StageOptions options, input_ring& input,
+                 const std::atomic<bool>& upstream_done,
+                 std::size_t output_capacity)
+      : base(std::move(options)),
+        f_(std::move(f)),
+        input_(input),
+        upstream_done_(upstream_done),
+        output_(make_output(output_capacity)) {}
+
+  [[nodiscard]] auto& output() noexcept
+    requires(!std::is_void_v<Out>)
+  {
+    return *output_;
+  }
+
+  [[nodiscard]] const typename base::instrumentation_type&
+  input_instrumentation() const noexcept override {
+    return input_.instrumentation();
+  }
+
+  void run() override {
+    if (this->options_.cpu >= 0) {
+      this->pinned_.store(pin_current_thread(this->options_.cpu),
+                          std::memory_order_relaxed);
+    }
+    spin_wait backoff;
+    for (;;) {
+      std::ptrdiff_t polled = 0;
+      try {
+        polled = this->error_ ? discard() : poll();
+      } catch (...) {
+        this->error_ = std::current_exception();
+        continue;
+      }
+      if (polled > 0) {
+        backoff = spin_wait();
+        continue;
+      }
+      flush();
+      // Upstream publishes its last elements before setting done
+      if (polled == 0 && upstream_done_.load(std::memory_order_acquire) &&
+          input_.front_n(1).empty()) {
+        break;
+      }
+      if (!backoff.once()) {
+        std::this_thread::yield();
+      }
+    }
+    flush();
+    this->done_.store(true, std::memory_order_release);
+  }
+
+ private:
+  static constexpr bool is_sink = std::is_void_v<Out>;
+
+  using output_type = typename stage_output_ring<Out, Traits>::type;
+
+  static output_type make_output(std::size_t capacity) {
+    if constexpr (is_sink) {
+      (void)capacity;
+      return nullptr;
+    } else {
+      return std::make_unique<pipeline_ring<Out, Traits>>(capacity);
+    }
+  }
+
+  static In& element(const typename input_ring::span_pair& batch,
+                     std::size_t i) noexcept {
+    return i < batch.first.size() ? batch.first[i]
+                                  : batch.second[i - batch.first.size()];
+  }
+
+  // Returns the inputs consumed, 0 if the input was empty and -1 if the
+  // output was full
+  std::ptrdiff_t poll() {
+    const auto batch = input_.front_n(this->options_.max_batch);
+    auto count = batch.size();
+    if (count == 0) {
+      base::bump(this->idle_polls_);
+      return 0;
+    }
+
+    if constexpr (is_sink) {
+      for (std::size_t i = 0; i < count; ++i) {
+        std::invoke(f_, element(batch, i));
+      }
+    } else {
+      const auto slots = output_->reserve_n(count);
+      if (slots.empty()) {
+        base::bump(this->stalls_);
+        return -1;
+      }
+      count = std::min(count, slots.size());
+      std::size_t produced = 0;
+      try {
+        for (std::size_t i = 0; i < count; ++i) {
+          Out* slot = produced < slots.first.size()
+                          ? &slots.first[produced]
+                          : &slots.second[produced - slots.first.size()];
+          if constexpr (is_optional<result_type>::value) {
+            if (auto result = std::invoke(f_, element(batch, i))) {
+              std::construct_at(slot, std::move(*result));
+              ++produced;
+            }
+          } else {
+            std::construct_at(slot, std::invoke(f_, element(batch, i)));
+            ++produced;
+          }
+        }
+      } catch (...) {
+        // Constructed slots are owned by the ring only once committed
+        output_->commit_n(produced);
+        throw;
+      }
+      output_->commit_n(produced);
+    }
+
+    input_.pop_n(count);
+    base::bump(this->processed_, count);
+    base::bump(this->batches_);
+    return static_cast<std::ptrdiff_t>(count);
+  }
+
+  // Drops up to max_batch inputs after F has thrown; returns the count
+  std::ptrdiff_t discard() noexcept {
+    const auto count = input_.front_n(this->options_.max_batch).size();
+    input_.pop_n(count);
+    return static_cast<std::ptrdiff_t>(count);
+  }
+
+  // Publishes whatever lazy publication still holds back on either side
+  void flush() noexcept {
+    input_.flush_consumer();
+    if constexpr (!is_sink) {
+      output_->flush();
+    }
+  }
+
+  F f_;
+  input_ring& input_;
+  const std::atomic<bool>& upstream_done_;
+  output_type output_;
+};
+
+template <typename In, typename Traits>
+struct pipeline_state {
+  explicit pipeline_state(std::size_t capacity)
+      : capacity(capacity), source(capacity) {}
+
+  std::size_t capacity;  ///< Default capacity of every ring
+  pipeline_ring<In, Traits> source;
+  std::atomic<bool> closed{false};
+  std::vector<std::unique_ptr<pipeline_stage_base<Traits>>> stages;
+  std::vector<std::thread> threads;
+};
+
+}  // namespace detail
+
+template <typename In, typename Traits>
+class Pipeline;
+
+/**
+ * @brief Builder returned by make_pipeline(), typed on the output of the
+ *        last stage added so far
+ * @tparam In Type the pipeline is fed with
+ * @tparam Last Output type of the last stage, the input of the next one
+ * @tparam Traits Traits of every ring between stages
+ */
+template <typename In, typename Last, typename Traits>
+class PipelineBuilder {
+ public:
+  /**
+   * @brief Append a stage transforming Last into F's result
+   * @param f Callable invoked as f(Last&) on the stage's thread; returning
+   *        std::optional<U> emits U and drops the element on std::nullopt
+   * @param options Name, CPU, batch size and output capacity of the stage
+   * @return The builder, now typed on the stage's output
+   */
+  template <typename F>
+  [[nodiscard]] auto stage(F f, StageOptions options = {}) && {
+    using out = typename detail::stage_output<
+        std::invoke_result_t<F&, Last&>>::type;
+    static_assert(!std::is_void_v<out>, "use sink() for the last stage");
+    auto* stage = add<out>(std::move(f), std::move(options));
+    return PipelineBuilder<In, out, Traits>(std::move(state_),
+                                            stage->output(), stage->done());
+  }
+
+  /**
+   * @brief Append the final stage, which consumes Last
+   * @param f Callable invoked as f(Last&) on the stage's thread
+   * @param options Name, CPU and batch size of the stage
+   * @return The pipeline, not yet started
+   */
+  template <typename F>
+  [[nodiscard]] Pipeline<In, Traits> sink(F f, StageOptions options = {}) && {
+    add<void>(std::move(f), std::move(options));
+    return Pipeline<In, Traits>(std::move(state_));
+  }
+
+ private:
+  template <typename, typename, typename>
+  friend class PipelineBuilder;
+  template <typename I, typename T>
+  friend PipelineBuilder<I, I, T> make_pipeline(std::size_t);
+
+  using state_type = detail::pipeline_state<In, Traits>;
+
+  PipelineBuilder(std::unique_ptr<state_type> state,
+                  detail::pipeline_ring<Last, Traits>& tail,
+                  const std::atomic<bool>& tail_done) noexcept
+      : state_(std::move(state)), tail_(tail), tail_done_(tail_done) {}
+
+  template <typename Out, typename F>
+  auto* add(F f, StageOptions options) {
+    const auto capacity =
+        options.capacity != 0 ? options.capacity : state_->capacity;
+    auto stage =
+        std::make_unique<detail::pipeline_stage<Last, Out, F, Traits>>(
+            std::move(f), std::move(options), tail_, tail_done_, capacity);
+    auto* raw = stage.get();
+    state_->stages.push_back(std::move(stage));
+    return raw;
+  }
+
+  std::unique_ptr<state_type> state_;
+  detail::pipeline_ring<Last, Traits>& tail_;
+  const std::atomic<bool>& tail_done_;
+};
+
+/**
+ * @brief Chain of stages, each on its own thread, joined by SPSC rings
+ * @tparam In Type the pipeline is fed with
+ * @tparam Traits Traits of every ring between stages
+ *
+ * Built with make_pipeline(). Each stage runs its callable on a thread
+ * pinned to the CPU in its StageOptions. It drains its input ring in
+ * batches of up to max_batch and writes results straight into the next
+ * ring's slots, publishing each batch with one index store. A full output
+ * stalls the stage, so backpressure propagates upstream to try_push().
+ *
+ * stats() reports every stage's counters. input_instrumentation() exposes
+ * the Traits::instrumentation of the ring feeding the stage. With the
+ * default PipelineTraits that is a LatencyInstrumentation, whose residency
+ * histogram and high-water mark show where backlog builds.
+ *
+ * A stage whose callable throws keeps draining its input without calling
+ * it again, and stop() rethrows the exception once every thread is joined.
+ * @warning try_push()/push()/close() must be called from a single thread.
+ * @code
+ * auto pipeline = fadli::make_pipeline<Packet>(4096)
+ *     .stage(decode, {.name = "decode", .cpu = 2})
+ *     .stage(normalize, {.name = "normalize", .cpu = 3})
+ *     .sink(publish, {.name = "publish", .cpu = 4});
+ * pipeline.start();
+ * pipeline.push(packet);
+ * pipeline.stop();  // drains every stage, then joins
+ * @endcode
+ */
+template <typename In, typename Traits = PipelineTraits>
+class Pipeline {
+ public:
+  using value_type = In;
+  using size_type = std::size_t;
+  using instrumentation_type = typename Traits::instrumentation;
+
+  Pipeline(Pipeline&&) noexcept = default;
+  Pipeline& operator=(Pipeline&&) = delete;
+  Pipeline(const Pipeline&) = delete;
+  Pipeline& operator=(const Pipeline&) = delete;
+
+  /**
+   * @brief Destructor
+   * @note Stops the pipeline if it is still running, draining it first
+   */
+  ~Pipeline() {
+    if (state_) {
+      join();
+    }
+  }
+
+  /**
+   * @brief Launch one thread per stage
+   * @throws std::system_error If a thread cannot be started
+   */
+  void start() {
+    for (auto& stage : state_->stages) {
+      state_->threads.emplace_back([s = stage.get()] { s->run(); });
+    }
+  }
+
+  /**
+   * @brief Attempt to feed an element into the first stage
+   * @param item The element to add
+   * @return true if the element was added, false if the first ring is full
+   */
+  template <typename U>
+    requires std::is_constructible_v<In, U&&>
+  [[nodiscard]] bool try_push(U&& item) {
+    return state_->source.try_emplace(std::forward<U>(item));
+  }
+
+  /**
+   * @brief Feed an element into the first stage, waiting while it is full
+   * @param item The element to add
+   */
+  template <typename U>
+    requires std::is_constructible_v<In, U&&>
+  void push(U&& item) {
+    detail::spin_wait backoff;
+    while (!state_->source.try_emplace(std::forward<U>(item))) {
+      if (!backoff.once()) {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  /**
+   * @brief Signal end of input; stages exit once they have drained
+   */
+  void close() noexcept {
+    state_->source.flush();
+    state_->closed.store(true, std::memory_order_release);
+  }
+
+  /**
+   * @brief Close the input and wait for every stage to drain and exit
+   * @throws The first exception thrown by a stage callable, in stage order
+   */
+  void stop() {
+    join();
+    for (auto& stage : state_->stages) {
+      if (const auto error = stage->error()) {
+        std::rethrow_exception(error);
+      }
+    }
+  }
+
+  /**
+   * @brief Get the number of stages
+   */
+  [[nodiscard]] size_type stages() const noexcept {
+    return state_->stages.size();
+  }
+
+  /**
+   * @brief Get a snapshot of a stage's counters
+   * @param stage Index of the stage, in the order they were added
+   * @note Safe to call from any thread while the pipeline runs
+   */
+  [[nodiscard]] StageStats stats(size_type stage) const {
+    return state_->stages[stage]->stats();
+  }
+
+  /**
+   * @brief Get the instrumentation of the ring feeding a stage
+   * @param stage Index of the stage, in the order they were added
+   * @note Safe to call from any thread while the pipeline runs, as far as
+   *       the instrumentation policy allows
+   */
+  [[nodiscard]] const instrumentation_type& input_instrumentation(
+      size_type stage) const noexcept {
+    return state_->stages[stage]->input_instrumentation();
+  }
+
+ private:
+  template <typename, typename, typename>
+  friend class PipelineBuilder;
+
+  explicit Pipeline(std::unique_ptr<detail::pipeline_state<In, Traits>> state)
+      : state_(std::move(state)) {}
+
+  void join() {
+    close();
+    for (auto& thread : state_->threads) {
+      if (thread.joinable()) {
+        thread.join();
+      }
+    }
+    state_->threads.clear();
+  }
+
+  std::unique_ptr<detail::pipeline_state<In, Traits>> state_;
+};
+
+/**
+ * @brief Start building a pipeline fed with In
+ * @tparam In Type the pipeline is fed with
+ * @tparam Traits Traits of every ring between stages
+ * @param capacity Default capacity of every ring (rounded up to power of 2)
+ * @return A builder to add stages to with stage() and finish with sink()
+ * @throws std::bad_alloc If memory allocation fails
+ */
+template <typename In, typename Traits = PipelineTraits>
+[[nodiscard]] PipelineBuilder<In, In, Traits> make_pipeline(
+    std::size_t capacity) {
+  auto state = std::make_unique<detail::pipeline_state<In, Traits>>(capacity);
+  auto& source = state->source;
+  const auto& closed = state->closed;
+  return PipelineBuilder<In, In, Traits>(std::move(state), source, closed);
+}
+
+}  // namespace fadli
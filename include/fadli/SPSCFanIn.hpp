@@ -0,0 +1,297 @@
+/**
+ * @file SPSCFanIn.hpp
+ * @brief One consumer draining many SPSCRingBuffers through a ready bitmap.
+ * @author Fadli Arsani <fadlialim0029@gmail.com>
+ * @version 1.0.0
+ *
+ * MIT License
+ *
+ * Copyright (c) 2025 Fadli Arsani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+#include "SPSCRingBuffer.hpp"
+
+namespace fadli {
+
+/**
+ * @brief Order in which SPSCFanIn serves the rings that have data
+ */
+enum class FanInOrder {
+  round_robin,  ///< Resume after the ring served last
+  priority,     ///< Always start from ring 0, the highest priority
+};
+
+/**
+ * @brief Single consumer of one SPSCRingBuffer per producer
+ * @tparam T The type of elements stored in the rings
+ * @tparam Allocator Allocator for the slots of each ring
+ *
+ * Producers keep their own ring, so they never contend with each other, and
+ * flag it in a shared ready bitmap when it may have become non-empty. The
+ * consumer only looks at flagged rings, so an idle sweep reads the bitmap
+ * instead of every ring's tail.
+ *
+ * The bit is cleared by the consumer once it finds the ring drained, and
+ * re-set by the producer when a push takes the ring from empty to
+ * non-empty. Both sides separate their write from the following reads with
+ * a seq_cst fence, so either the producer sees the ring was drained and its
+ * bit cleared, or the consumer's re-check sees the new element. A push
+ * to a ring the consumer has not caught up with touches no shared line
+ * beyond the ring's own indices.
+ * @warning Each producer index must be used by a single thread only.
+ * @code
+ * fadli::SPSCFanIn<Order> in(32, 4096);
+ *
+ * // Producer thread i
+ * while (!in.try_push(i, order));
+ *
+ * // Consumer thread
+ * in.poll([](Order& o) { route(o); });
+ * @endcode
+ */
+template <typename T, typename Allocator = AlignedAllocator<T>>
+class SPSCFanIn {
+ public:
+  using ring_type = SPSCRingBuffer<T, dynamic_capacity, Allocator>;
+  using value_type = T;
+  using size_type = std::size_t;
+
+  /**
+   * @brief Constructs the rings
+   * @param producers Number of producers, each with its own ring
+   * @param capacity Capacity of every ring (rounded up to power of 2)
+   * @param order How the consumer picks among rings with data
+   * @param alloc Allocator for the slots of each ring
+   * @throws std::invalid_argument If producers is 0
+   * @throws std::bad_alloc If memory allocation fails
+   */
+  SPSCFanIn(size_type producers, size_type capacity,
+            FanInOrder order = FanInOrder::round_robin,
+            const Allocator& alloc = Allocator())
+      : order_(order),
+        ready_(std::make_unique<ready_word[]>(
+            (checked_producers(producers) + word_bits - 1) / word_bits)) {
+    rings_.reserve(producers);
+    for (size_type i = 0; i < producers; ++i) {
+      rings_.push_back(std::make_unique<ring_type>(capacity, alloc));
+    }
+  }
+
+  /**
+   * @brief Attempt to construct an element in place in a producer's ring
+   * @param producer Index of the calling producer
+   * @param args Arguments forwarded to the constructor of T
+   * @return true if the element was successfully added, false if that ring
+   *         is full
+   * @note This function should only be called from that producer's thread
+   */
+  template <typename... Args>
+  [[nodiscard]] bool try_emplace(size_type producer, Args&&... args) noexcept(
+      std::is_nothrow_constructible_v<T, Args&&...>) {
+    if (!rings_[producer]->try_emplace(std::forward<Args>(args)...)) {
+      return false;
+    }
+    announce(producer);
+    return true;
+  }
+
+  /**
+   * @brief Attempt to push an element into a producer's ring (copy version)
+   * @param producer Index of the calling producer
+   * @param item The element to add
+   * @return true if the element was successfully added, false if that ring
+   *         is full
+   * @note This function should only be called from that producer's thread
+   */
+  [[nodiscard]] bool try_push(size_type producer, const T& item) noexcept(
+      std::is_nothrow_copy_constructible_v<T>) {
+    return try_emplace(producer, item);
+  }
+
+  /**
+   * @brief Attempt to push an element into a producer's ring (move version)
+   * @param producer Index of the calling producer
+   * @param item The element to move in
+   * @return true if the element was successfully added, false if that ring
+   *         is full
+   * @note This function should only be called from that producer's thread
+   */
+  [[nodiscard]] bool try_push(size_type producer, T&& item) noexcept(
+      std::is_nothrow_move_constructible_v<T>) {
+    return try_emplace(producer, std::move(item));
+  }
+
+  /**
+   * @brief Drain every ring with data once, in the configured order
+   * @param f Called with a T& for each element, in FIFO order per ring
+   * @param max_batch Maximum number of elements taken from one ring, which
+   *        bounds how long a busy producer can delay the others
+   * @return The number of elements processed
+   * @note This function should only be called from the consumer thread
+   * @note Elements handed to f are destroyed once f returns for the batch
+   */
+  template <typename F>
+  size_type poll(F&& f, size_type max_batch = 64) {
+    size_type processed = 0;
+    for_each_ready([&](size_type index) {
+      auto& ring = *rings_[index];
+      const auto batch = ring.front_n(max_batch);
+      for (auto& item : batch.first) {
+        f(item);
+      }
+      for (auto& item : batch.second) {
+        f(item);
+      }
+      ring.pop_n(batch.size());
+      processed += batch.size();
+      if (batch.size() < max_batch) {
+        retire(index);
+      }
+      return true;
+    });
+    return processed;
+  }
+
+  /**
+   * @brief Attempt to pop one element from the next ring with data
+   * @return std::optional containing the popped element, std::nullopt if
+   *         every ring is empty
+   * @note This function should only be called from the consumer thread
+   */
+  [[nodiscard]] std::optional<T> try_pop() noexcept(
+      std::is_nothrow_move_constructible_v<T>) {
+    std::optional<T> item;
+    for_each_ready([&](size_type index) {
+      auto& ring = *rings_[index];
+      item = ring.try_pop();
+      if (!item || ring.empty()) {
+        retire(index);
+      }
+      return !item;  // Keep looking only if this ring was already empty
+    });
+    return item;
+  }
+
+  /**
+   * @brief Get the number of producers
+   */
+  [[nodiscard]] size_type producers() const noexcept { return rings_.size(); }
+
+  /**
+   * @brief Access a producer's ring, e.g. for its size or instrumentation
+   * @warning Pushing into it directly bypasses the ready bitmap
+   */
+  [[nodiscard]] const ring_type& ring(size_type producer) const noexcept {
+    return *rings_[producer];
+  }
+
+ private:
+  static constexpr size_type word_bits = 64;
+
+  // One word per line: producers of different words never share a line
+  struct alignas(detail::cache_line_size) ready_word {
+    std::atomic<std::uint64_t> bits{0};
+  };
+
+  static size_type checked_producers(size_type producers) {
+    if (producers == 0) {
+      throw std::invalid_argument("SPSCFanIn needs at least one producer");
+    }
+    return producers;
+  }
+
+  // Called after a push; the fence orders the ring's tail store before these
+  // loads, pairing with the one in retire(). Unless the ring held only the
+  // new element, the consumer has yet to drain it and will see the element
+  // when it re-checks after clearing the bit, so the bitmap is left alone.
+  void announce(size_type producer) noexcept {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const auto& ring = *rings_[producer];
+    const auto tail = ring.pushed_count();
+    if (tail - ring.popped_count() != 1) {
+      return;
+    }
+    auto& word = ready_[producer / word_bits].bits;
+    const auto bit = std::uint64_t{1} << (producer % word_bits);
+    if (!(word.load(std::memory_order_relaxed) & bit)) {
+      word.fetch_or(bit, std::memory_order_release);
+    }
+  }
+
+  // Clear a drained ring's bit, restoring it if a push raced with the clear
+  void retire(size_type index) noexcept {
+    auto& word = ready_[index / word_bits].bits;
+    const auto bit = std::uint64_t{1} << (index % word_bits);
+    word.fetch_and(~bit, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!rings_[index]->empty()) {
+      word.fetch_or(bit, std::memory_order_relaxed);
+    }
+  }
+
+  // Visit flagged rings once in the configured order until visit returns
+  // false; round robin resumes after the ring visited last
+  template <typename Visit>
+  void for_each_ready(Visit&& visit) {
+    const auto count = rings_.size();
+    const size_type start = order_ == FanInOrder::round_robin ? cursor_ : 0;
+    const auto words = (count + word_bits - 1) / word_bits;
+
+    // One pass over all words plus the part of the start word before start
+    for (size_type w = 0; w <= words; ++w) {
+      const auto word_index = (start / word_bits + w) % words;
+      auto bits = ready_[word_index].bits.load(std::memory_order_acquire);
+      const auto base = word_index * word_bits;
+      if (w == 0) {
+        bits &= ~std::uint64_t{0} << (start % word_bits);
+      } else if (w == words) {
+        bits &= (std::uint64_t{1} << (start % word_bits)) - 1;
+      }
+      while (bits != 0) {
+        const auto index =
+            base + static_cast<size_type>(std::countr_zero(bits));
+        bits &= bits - 1;
+        cursor_ = (index + 1) % count;
+        if (!visit(index)) {
+          return;
+        }
+      }
+    }
+  }
+
+  FanInOrder order_;
+  size_type cursor_{0};  ///< Consumer: next ring in round-robin order
+  std::vector<std::unique_ptr<ring_type>> rings_;
+  std::unique_ptr<ready_word[]> ready_;
+};
+
+}  // namespace fadli
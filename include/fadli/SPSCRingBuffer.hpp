@@ -29,14 +29,36 @@
 
 #pragma once
 
+#include <algorithm>
 #include <atomic>
+#include <bit>
 #include <cassert>
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
 #include <new>
 #include <optional>
+#include <span>
+#include <thread>
 #include <type_traits>
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
 namespace fadli {
 
+/**
+ * @brief Capacity argument selecting a heap-allocated, runtime-sized buffer
+ */
+inline constexpr std::size_t dynamic_capacity = 0;
+
 namespace detail {
 #ifdef __cpp_lib_hardware_interference_size
 inline constexpr std::size_t cache_line_size =
@@ -44,13 +66,440 @@ inline constexpr std::size_t cache_line_size =
 #else
 inline constexpr std::size_t cache_line_size = 64;
 #endif
+
+// Helper function to round up to next power of 2
+constexpr std::size_t next_power_of_2(std::size_t n) noexcept {
+  if (n == 0) return 1;
+  n--;
+  n |= n >> 1;
+  n |= n >> 2;
+  n |= n >> 4;
+  n |= n >> 8;
+  n |= n >> 16;
+  n |= n >> 32;
+  return n + 1;
+}
+
+// Slots start on their own cache line, and over-aligned T is honoured
+template <typename T>
+inline constexpr std::size_t slot_alignment =
+    alignof(T) > cache_line_size ? alignof(T) : cache_line_size;
+
+// Hint to the CPU that we are busy-waiting
+inline void cpu_relax() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+  _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+  asm volatile("yield" ::: "memory");
+#endif
+}
+
+// Bulk copy of trivially copyable elements. memcpy is already the widest
+// kernel the target has: glibc picks its AVX2, AVX-512, ERMS or NEON
+// variant for the running CPU when the program is loaded.
+template <typename T>
+inline void copy_elements(T* dst, const T* src, std::size_t n) noexcept {
+  if (n != 0) {
+    std::memcpy(dst, src, n * sizeof(T));
+  }
+}
+
+// Allocators with their own construct() must still see every element
+template <typename Allocator, typename T>
+inline constexpr bool has_custom_construct =
+    requires(Allocator& a, T* p, const T& v) { a.construct(p, v); };
+
+// Software prefetch of every line of *p, with intent to write if Write (a
+// PREFETCHW where the target has it, e.g. with -mprfchw)
+template <bool Write, typename T>
+inline void prefetch_lines(const T* p) noexcept {
+  const auto* bytes = reinterpret_cast<const char*>(p);
+  for (std::size_t offset = 0; offset < sizeof(T); offset += cache_line_size) {
+    __builtin_prefetch(bytes + offset, Write ? 1 : 0, 3);
+  }
+}
+
+// Move every line of *p from this core's private caches toward the shared
+// LLC, so the other core's first read is not a cross-core snoop. CLDEMOTE
+// is encoded in the hint-NOP space, so older x86 CPUs simply ignore it.
+template <typename T>
+inline void demote_lines(const T* p) noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+  const auto* bytes = reinterpret_cast<const char*>(p);
+  for (std::size_t offset = 0; offset < sizeof(T); offset += cache_line_size) {
+    asm volatile("cldemote %0" : : "m"(bytes[offset]));
+  }
+#else
+  (void)p;
+#endif
+}
+
+/**
+ * @brief Bounded backoff used before a blocking call parks the thread
+ *
+ * Spins with cpu_relax() first, then yields, so a peer that is only briefly
+ * behind is picked up within microseconds without a syscall.
+ */
+class spin_wait {
+ public:
+  static constexpr unsigned spin_limit = 256;
+  static constexpr unsigned yield_limit = 32;
+
+  /// Back off once; returns false when the budget is spent and it is time
+  /// to park
+  bool once() noexcept {
+    if (count_ < spin_limit) {
+      cpu_relax();
+    } else if (count_ < spin_limit + yield_limit) {
+      std::this_thread::yield();
+    } else {
+      return false;
+    }
+    ++count_;
+    return true;
+  }
+
+ private:
+  unsigned count_{0};
+};
+
+/**
+ * @brief Backoff for the timed calls, which cannot park on std::atomic::wait
+ *
+ * Spins like spin_wait, then sleeps with an exponentially growing interval
+ * capped at max_sleep so that a wakeup is never missed by more than that.
+ */
+template <typename Clock, typename Duration>
+class timed_wait {
+ public:
+  static constexpr std::chrono::microseconds max_sleep{100};
+
+  explicit timed_wait(
+      std::chrono::time_point<Clock, Duration> deadline) noexcept
+      : deadline_(deadline) {}
+
+  /// Back off once; returns false once the deadline has passed
+  bool once() {
+    const auto now = Clock::now();
+    if (now >= deadline_) {
+      return false;
+    }
+    if (spinner_.once()) {
+      return true;
+    }
+    const auto remaining = deadline_ - now;
+    using sleep_duration = std::common_type_t<decltype(remaining),
+                                              std::chrono::microseconds>;
+    std::this_thread::sleep_for(
+        std::min(sleep_duration(sleep_), sleep_duration(remaining)));
+    sleep_ = std::min(sleep_ * 2, max_sleep);
+    return true;
+  }
+
+ private:
+  std::chrono::time_point<Clock, Duration> deadline_;
+  std::chrono::microseconds sleep_{1};
+  spin_wait spinner_;
+};
+
+/**
+ * @brief Storage for a trivially copyable value guarded by a seqlock
+ *
+ * The value is held as atomic words so that a reader racing the writer is
+ * well defined; the caller's sequence check discards what it read. Stores
+ * are release and loads acquire, which orders the writer's odd sequence
+ * before its data and the reader's data before its second sequence load
+ * without standalone fences, and costs plain moves on x86.
+ */
+template <typename T>
+class seqlock_cell {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "seqlock_cell requires a trivially copyable T");
+
+  static constexpr std::size_t words =
+      (sizeof(T) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+
+ public:
+  void store(const T& value) noexcept {
+    std::uint64_t buffer[words] = {};
+    std::memcpy(buffer, &value, sizeof(T));
+    for (std::size_t i = 0; i < words; ++i) {
+      words_[i].store(buffer[i], std::memory_order_release);
+    }
+  }
+
+  [[nodiscard]] T load() const noexcept {
+    std::uint64_t buffer[words];
+    for (std::size_t i = 0; i < words; ++i) {
+      buffer[i] = words_[i].load(std::memory_order_acquire);
+    }
+    unsigned char bytes[sizeof(T)];
+    std::memcpy(bytes, buffer, sizeof(T));
+    return std::bit_cast<T>(bytes);
+  }
+
+ private:
+  std::atomic<std::uint64_t> words_[words];
+};
+}  // namespace detail
+
+/**
+ * @brief Minimal allocator returning storage aligned to Alignment bytes
+ * @tparam T The type of elements to allocate
+ * @tparam Alignment Alignment of every allocation (power of 2, at least
+ *         alignof(T)); defaults to a cache line so slots never share a line
+ *         with the start of a neighbouring heap object
+ */
+template <typename T, std::size_t Alignment = detail::slot_alignment<T>>
+class AlignedAllocator {
+  static_assert(Alignment >= alignof(T) && (Alignment & (Alignment - 1)) == 0,
+                "Alignment must be a power of 2 of at least alignof(T)");
+
+ public:
+  using value_type = T;
+
+  template <typename U>
+  struct rebind {
+    using other = AlignedAllocator<U, Alignment>;
+  };
+
+  AlignedAllocator() noexcept = default;
+  template <typename U>
+  AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+  /**
+   * @brief Allocate storage for n elements
+   * @note The size is rounded up to a multiple of Alignment, so with the
+   *       default alignment the last line is never shared with a neighbouring
+   *       heap object either
+   */
+  [[nodiscard]] T* allocate(std::size_t n) {
+    if (n > (std::size_t(-1) - Alignment) / sizeof(T)) {
+      throw std::bad_array_new_length();
+    }
+    const auto bytes = (n * sizeof(T) + Alignment - 1) & ~(Alignment - 1);
+    return static_cast<T*>(::operator new(bytes, std::align_val_t{Alignment}));
+  }
+
+  void deallocate(T* p, std::size_t) noexcept {
+    ::operator delete(p, std::align_val_t{Alignment});
+  }
+
+  friend bool operator==(const AlignedAllocator&,
+                         const AlignedAllocator&) noexcept {
+    return true;
+  }
+};
+
+/**
+ * @brief Instrumentation policy that records nothing
+ *
+ * Documents the hooks SPSCRingBuffer invokes; every one is an empty inline
+ * function, so the default policy compiles away entirely. Producer hooks are
+ * only called from the producer thread and consumer hooks from the consumer
+ * thread. Indices are the unmasked positions passed to the slots. See
+ * fadli/Instrumentation.hpp for a latency histogram and counters.
+ */
+struct NullInstrumentation {
+  constexpr explicit NullInstrumentation(std::size_t /*capacity*/) noexcept {}
+
+  /// Producer: slots [first, first + count) are about to be published
+  void on_publish(std::size_t /*first*/, std::size_t /*count*/) noexcept {}
+  /// Producer: a push could not store anything because the buffer was full
+  void on_full() noexcept {}
+  /// Producer: head_cache_ was stale and head_ had to be reloaded
+  void on_head_refresh() noexcept {}
+
+  /// Consumer: tail_cache_ was stale; occupancy is what the reload revealed
+  void on_tail_refresh(std::size_t /*occupancy*/) noexcept {}
+  /// Consumer: slots [first, first + count) are about to be released
+  void on_consume(std::size_t /*first*/, std::size_t /*count*/) noexcept {}
+};
+
+/**
+ * @brief Mapping of logical slots onto the slot array
+ */
+enum class SlotLayout {
+  contiguous,  ///< Slot i is element i; the only layout with span access
+  padded,      ///< Every slot is padded to its own cache line
+  scrambled,   ///< Consecutive slots are spread over different cache lines
+               ///< without padding; needs a power-of-2 sizeof(T) below a line
+};
+
+/**
+ * @brief What the producer does with a slot's lines once it has written them
+ */
+enum class CacheHint {
+  none,    ///< Leave them in the producer's cache
+  demote,  ///< CLDEMOTE them toward the shared LLC (x86, no-op elsewhere);
+           ///< needs elements of at least a cache line
+};
+
+/**
+ * @brief Occupancy threshold crossed, as reported by watermark callbacks
+ */
+enum class Watermark {
+  high,  ///< Occupancy rose to the high watermark or above
+  low,   ///< Occupancy fell back to the low watermark or below
+};
+
+/**
+ * @brief Default compile-time options of SPSCRingBuffer
+ *
+ * Customize by deriving and overriding individual members:
+ * @code
+ * struct Traits : fadli::SPSCRingBufferTraits {
+ *   using instrumentation = fadli::LatencyInstrumentation<>;
+ * };
+ * fadli::SPSCRingBuffer<Msg, 4096, fadli::AlignedAllocator<Msg>, Traits> q;
+ * @endcode
+ */
+struct SPSCRingBufferTraits {
+  /// Hooks invoked on the hot paths; see NullInstrumentation
+  using instrumentation = NullInstrumentation;
+
+  /// Each side publishes its index only once this many elements have been
+  /// pushed or popped since its last publish; see SPSCRingBuffer::flush()
+  static constexpr std::size_t publish_interval = 1;
+
+  /// How slots are laid out; the non-contiguous layouts keep a nearly empty
+  /// buffer from having producer and consumer write the same cache line
+  static constexpr SlotLayout slot_layout = SlotLayout::contiguous;
+
+  /// Each side prefetches the slot this many positions past its next one, 0
+  /// to disable: for writing on the producer, for reading on the consumer
+  static constexpr std::size_t prefetch_distance = 0;
+
+  /// Applied by the producer to every slot it publishes; see CacheHint
+  static constexpr CacheHint publish_hint = CacheHint::none;
+
+  /// Make every index publish wake a thread parked in push() or pop_wait()
+  /// on the other side, at the cost of a seq_cst fence per publish. Without
+  /// it only the other side's blocking calls wake a parked thread, so mixing
+  /// push() or pop_wait() with a try_* peer needs this flag.
+  static constexpr bool blocking = false;
+};
+
+namespace detail {
+
+// Element storage of one slot in the given layout
+template <typename T, SlotLayout Layout>
+struct slot_cell {
+  using type = T;
+};
+
+template <typename T>
+struct slot_cell<T, SlotLayout::padded> {
+  struct alignas(slot_alignment<T>) type {
+    std::byte bytes[sizeof(T)];
+  };
+};
+
+template <typename T, SlotLayout Layout>
+using slot_cell_t = typename slot_cell<T, Layout>::type;
+
+/**
+ * @brief Inline slot storage for a capacity fixed at compile time
+ * @tparam T The type of elements stored in the slots
+ * @tparam Capacity Requested capacity (rounded up to power of 2)
+ * @tparam Allocator Only used to construct and destroy elements in place
+ * @tparam Cell Storage of one slot, T itself unless slots are padded
+ */
+template <typename T, std::size_t Capacity, typename Allocator,
+          typename Cell = T>
+class ring_storage {
+  static constexpr std::size_t capacity_ = next_power_of_2(Capacity);
+  // Rounded up so the last slot never shares a line with the next member
+  static constexpr std::size_t bytes_ =
+      (capacity_ * sizeof(Cell) + cache_line_size - 1) &
+      ~(cache_line_size - 1);
+
+ public:
+  ring_storage() noexcept(
+      std::is_nothrow_default_constructible_v<Allocator>) = default;
+  explicit ring_storage(const Allocator& alloc) noexcept : alloc_(alloc) {}
+
+  [[nodiscard]] static constexpr std::size_t capacity() noexcept {
+    return capacity_;
+  }
+  [[nodiscard]] static constexpr std::size_t index_mask() noexcept {
+    return capacity_ - 1;
+  }
+  [[nodiscard]] Cell* data() noexcept {
+    return reinterpret_cast<Cell*>(slots_);
+  }
+  [[nodiscard]] Allocator& allocator() noexcept { return alloc_; }
+  [[nodiscard]] const Allocator& allocator() const noexcept { return alloc_; }
+
+ private:
+  alignas(slot_alignment<Cell>) std::byte slots_[bytes_];
+  [[no_unique_address]] Allocator alloc_;
+};
+
+/**
+ * @brief Allocator-provided slot storage for a capacity chosen at runtime
+ * @tparam T The type of elements stored in the slots
+ * @tparam Allocator Allocator for the slot array, rebound to Cell
+ * @tparam Cell Storage of one slot, T itself unless slots are padded
+ */
+template <typename T, typename Allocator, typename Cell>
+class ring_storage<T, dynamic_capacity, Allocator, Cell> {
+  using cell_allocator =
+      typename std::allocator_traits<Allocator>::template rebind_alloc<Cell>;
+  using alloc_traits = std::allocator_traits<cell_allocator>;
+
+ public:
+  ring_storage(std::size_t capacity, const Allocator& alloc)
+      : capacity_(next_power_of_2(capacity)),
+        index_mask_(capacity_ - 1),
+        alloc_(alloc),
+        buffer_(allocate_cells(alloc_, capacity_)) {}
+
+  ~ring_storage() {
+    cell_allocator cells(alloc_);
+    alloc_traits::deallocate(cells, buffer_, capacity_);
+  }
+
+  ring_storage(const ring_storage&) = delete;
+  ring_storage& operator=(const ring_storage&) = delete;
+
+  [[nodiscard]] std::size_t capacity() const noexcept { return capacity_; }
+  [[nodiscard]] std::size_t index_mask() const noexcept { return index_mask_; }
+  [[nodiscard]] Cell* data() noexcept { return std::to_address(buffer_); }
+  [[nodiscard]] Allocator& allocator() noexcept { return alloc_; }
+  [[nodiscard]] const Allocator& allocator() const noexcept { return alloc_; }
+
+ private:
+  static typename alloc_traits::pointer allocate_cells(const Allocator& alloc,
+                                                       std::size_t n) {
+    cell_allocator cells(alloc);
+    return alloc_traits::allocate(cells, n);
+  }
+
+  std::size_t capacity_;    ///< Actual capacity (power of 2)
+  std::size_t index_mask_;  ///< Mask for fast modulo (capacity - 1)
+  [[no_unique_address]] Allocator alloc_;
+  typename alloc_traits::pointer buffer_;  ///< Storage for capacity_ slots
+};
 }  // namespace detail
 
 /**
  * @brief Lock-free single-producer single-consumer ring buffer
  * @tparam T The type of elements stored in the ring buffer
+ * @tparam Capacity Compile-time capacity (rounded up to power of 2) stored
+ *         inline in the object, or dynamic_capacity to size the heap-allocated
+ *         buffer at construction
+ * @tparam Allocator Allocator used for the slot array (dynamic capacity only)
+ *         and, through std::allocator_traits, to construct and destroy
+ *         elements; see fadli/Allocators.hpp for huge page and NUMA allocators
+ * @tparam Traits Compile-time options; see SPSCRingBufferTraits
+ * @note With Traits::publish_interval above 1, pushed elements may stay
+ *       invisible to the consumer until the producer pushes more, finds the
+ *       buffer full or calls flush(), and freed slots likewise until the
+ *       consumer pops more, finds the buffer empty or calls flush_consumer()
  * @warning This class is NOT thread-safe for multiple producers or consumers.
- *          Use appropriate sync. or consider MPSC variants for such cases.
+ *          Use appropriate sync. or the MPSC/SPMC/MPMC variants in
+ *          fadli/MPMCRingBuffer.hpp for such cases.
  * @code
  * fadli::SPSCRingBuffer<int> q(1024);
  *
@@ -62,56 +511,446 @@ inline constexpr std::size_t cache_line_size = 64;
  *     process(*val);
  *     q.pop();
  * }
+ *
+ * // Fixed capacity, no heap allocation
+ * fadli::SPSCRingBuffer<int, 1024> fixed;
  * @endcode
  */
-template <typename T>
+template <typename T, std::size_t Capacity = dynamic_capacity,
+          typename Allocator = AlignedAllocator<T>,
+          typename Traits = SPSCRingBufferTraits>
 class SPSCRingBuffer {
   static_assert(std::is_move_constructible_v<T>,
                 "T must be move constructible");
-  static_assert(std::is_move_assignable_v<T>, "T must be move assignable");
+  static_assert(std::is_nothrow_destructible_v<T>,
+                "T must be nothrow destructible");
+  static_assert(std::is_same_v<typename Allocator::value_type, T>,
+                "Allocator::value_type must be T");
+  static_assert(Traits::publish_interval >= 1,
+                "Traits::publish_interval must be at least 1");
+  static_assert(Traits::slot_layout != SlotLayout::scrambled ||
+                    (std::has_single_bit(sizeof(T)) &&
+                     sizeof(T) < detail::cache_line_size),
+                "SlotLayout::scrambled needs a power-of-2 sizeof(T) smaller "
+                "than a cache line; use SlotLayout::padded instead");
+  static_assert(Traits::publish_hint != CacheHint::demote ||
+                    sizeof(T) >= detail::cache_line_size,
+                "CacheHint::demote needs elements of at least a cache line; "
+                "smaller ones share their line with the next push");
 
  private:
-  // Helper function to round up to next power of 2
-  static constexpr std::size_t next_power_of_2(std::size_t n) noexcept {
-    if (n == 0) return 1;
-    n--;
-    n |= n >> 1;
-    n |= n >> 2;
-    n |= n >> 4;
-    n |= n >> 8;
-    n |= n >> 16;
-    n |= n >> 32;
-    return n + 1;
+  using alloc_traits = std::allocator_traits<Allocator>;
+  using instrumentation_type = typename Traits::instrumentation;
+
+  static constexpr SlotLayout slot_layout = Traits::slot_layout;
+  using cell_type = detail::slot_cell_t<T, slot_layout>;
+
+  detail::ring_storage<T, Capacity, Allocator, cell_type> storage_;
+  [[no_unique_address]] instrumentation_type instr_;
+
+  template <typename... Args>
+  void construct(T* p, Args&&... args) {
+    alloc_traits::construct(storage_.allocator(), p,
+                            std::forward<Args>(args)...);
   }
 
-  std::size_t capacity_;    ///< Actual capacity (power of 2)
-  std::size_t index_mask_;  ///< Mask for fast modulo (capacity - 1)
-  T* buffer_;               ///< Dynamically allocated buffer
+  void destroy(T* p) noexcept {
+    alloc_traits::destroy(storage_.allocator(), p);
+  }
 
-  // Separate cache lines to prevent false sharing between producer and consumer
-  alignas(detail::cache_line_size) std::atomic<std::size_t> head_{0};
+  // Ranges of T that can be memcpy'd into the slots instead of constructed
+  // one by one
+  template <typename It>
+  static constexpr bool bulk_copyable =
+      slot_layout == SlotLayout::contiguous &&
+      std::is_trivially_copyable_v<T> && std::contiguous_iterator<It> &&
+      std::is_same_v<std::remove_cv_t<std::iter_value_t<It>>, T> &&
+      !detail::has_custom_construct<Allocator, T>;
+
+  // Each side's fast path touches one private line holding its own index, its
+  // cached copy of the other index and copies of the slot pointer and mask,
+  // plus the shared index it publishes. The shared indices get lines of their
+  // own so polling one never invalidates the other side's private state.
+  struct alignas(detail::cache_line_size) producer_state {
+    std::size_t tail{0};            ///< Producer's tail, possibly unpublished
+    std::size_t head_cache{0};      ///< Last value of head_ seen
+    std::size_t published_tail{0};  ///< Last value stored to tail_
+    cell_type* slots;               ///< Copy of storage_.data()
+    std::size_t index_mask;         ///< Copy of storage_.index_mask()
+    std::size_t line_shift;         ///< log2 of the lines, scrambled layout
+    std::size_t refresh_at;         ///< Cached occupancy to reload head_ at
+  };
+
+  struct alignas(detail::cache_line_size) consumer_state {
+    std::size_t head{0};            ///< Consumer's head, possibly unpublished
+    std::size_t tail_cache{0};      ///< Last value of tail_ seen
+    std::size_t published_head{0};  ///< Last value stored to head_
+    cell_type* slots;               ///< Copy of storage_.data()
+    std::size_t index_mask;         ///< Copy of storage_.index_mask()
+    std::size_t line_shift;         ///< log2 of the lines, scrambled layout
+  };
+
+  static constexpr std::size_t publish_interval = Traits::publish_interval;
+  static constexpr std::size_t prefetch_distance = Traits::prefetch_distance;
+  static constexpr CacheHint publish_hint = Traits::publish_hint;
+  static constexpr bool blocking = Traits::blocking;
+
+  // Indices increase monotonically and are only masked on slot access, so all
+  // capacity() slots are usable and size is simply tail - head.
+  producer_state producer_{.slots = storage_.data(),
+                           .index_mask = storage_.index_mask(),
+                           .line_shift = line_shift_for(storage_.capacity()),
+                           .refresh_at = storage_.capacity()};
   alignas(detail::cache_line_size) std::atomic<std::size_t> tail_{0};
-  alignas(detail::cache_line_size) std::size_t head_cache_{0};
-  alignas(detail::cache_line_size) std::size_t tail_cache_{0};
+  consumer_state consumer_{.slots = storage_.data(),
+                           .index_mask = storage_.index_mask(),
+                           .line_shift = line_shift_for(storage_.capacity())};
+  alignas(detail::cache_line_size) std::atomic<std::size_t> head_{0};
+
+  // The scrambled layout views the array as a lines x slots_per_line matrix
+  // and fills it column by column: slot i lives in line i % lines at
+  // position i / lines, so consecutive slots never share a line.
+  static constexpr std::size_t per_line_shift =
+      slot_layout == SlotLayout::scrambled
+          ? std::countr_zero(detail::cache_line_size / sizeof(T))
+          : 0;
+
+  static constexpr std::size_t line_shift_for(std::size_t capacity) noexcept {
+    return capacity >> per_line_shift > 1
+               ? std::countr_zero(capacity >> per_line_shift)
+               : 0;
+  }
+
+  // With a compile-time capacity the slots and mask are constants of the
+  // object, so the copies are only read for a dynamic capacity
+  template <typename Side>
+  [[nodiscard]] cell_type* slots(const Side& side) noexcept {
+    if constexpr (Capacity == dynamic_capacity) {
+      return side.slots;
+    } else {
+      return storage_.data();
+    }
+  }
+
+  template <typename Side>
+  [[nodiscard]] std::size_t index_mask(const Side& side) const noexcept {
+    if constexpr (Capacity == dynamic_capacity) {
+      return side.index_mask;
+    } else {
+      return storage_.index_mask();
+    }
+  }
+
+  template <typename Side>
+  [[nodiscard]] std::size_t capacity(const Side& side) const noexcept {
+    return index_mask(side) + 1;
+  }
+
+  template <typename Side>
+  [[nodiscard]] std::size_t line_shift(const Side& side) const noexcept {
+    if constexpr (Capacity == dynamic_capacity) {
+      return side.line_shift;
+    } else {
+      return line_shift_for(storage_.capacity());
+    }
+  }
+
+  template <typename Side>
+  [[nodiscard]] T* slot(const Side& side, std::size_t index) noexcept {
+    const auto i = index & index_mask(side);
+    if constexpr (slot_layout == SlotLayout::contiguous) {
+      return slots(side) + i;
+    } else if constexpr (slot_layout == SlotLayout::padded) {
+      return reinterpret_cast<T*>(slots(side) + i);
+    } else {
+      const auto line_mask = index_mask(side) >> per_line_shift;
+      return slots(side) +
+             (((i & line_mask) << per_line_shift) | (i >> line_shift(side)));
+    }
+  }
+
+  // Lazy publication still makes progress: a producer that finds the buffer
+  // full publishes everything it has pushed, and a consumer that finds it
+  // empty releases everything it has popped, before reporting failure.
+  // With Traits::blocking every index store also wakes the other side if it
+  // is parked on that index; otherwise the fast path stays fence-free.
+  void publish_tail(std::size_t tail) noexcept {
+    producer_.tail = tail;
+    if constexpr (publish_interval == 1) {
+      tail_.store(tail, std::memory_order_release);
+      if constexpr (blocking) {
+        wake_consumer();
+      }
+    } else if (tail - producer_.published_tail >= publish_interval) {
+      producer_.published_tail = tail;
+      tail_.store(tail, std::memory_order_release);
+      if constexpr (blocking) {
+        wake_consumer();
+      }
+    }
+  }
+
+  void publish_head(std::size_t head) noexcept {
+    consumer_.head = head;
+    if constexpr (publish_interval == 1) {
+      head_.store(head, std::memory_order_release);
+      if constexpr (blocking) {
+        wake_producer();
+      }
+    } else if (head - consumer_.published_head >= publish_interval) {
+      consumer_.published_head = head;
+      head_.store(head, std::memory_order_release);
+      if constexpr (blocking) {
+        wake_producer();
+      }
+    }
+  }
+
+  // Stores whatever lazy publication still holds back; true if it did
+  bool publish_pending_tail() noexcept {
+    if constexpr (publish_interval != 1) {
+      if (producer_.tail != producer_.published_tail) {
+        producer_.published_tail = producer_.tail;
+        tail_.store(producer_.tail, std::memory_order_release);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool publish_pending_head() noexcept {
+    if constexpr (publish_interval != 1) {
+      if (consumer_.head != consumer_.published_head) {
+        consumer_.published_head = consumer_.head;
+        head_.store(consumer_.head, std::memory_order_release);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Prefetching a slot the other side still owns would pull its line away
+  // mid-access, so the producer only prefetches slots it knows are free and
+  // the consumer only slots it knows are published.
+  void prefetch_for_push(std::size_t tail) noexcept {
+    if constexpr (prefetch_distance != 0) {
+      const auto ahead = tail + prefetch_distance;
+      if (ahead - producer_.head_cache < capacity(producer_)) {
+        detail::prefetch_lines<true>(slot(producer_, ahead));
+      }
+    }
+  }
+
+  void prefetch_for_pop(std::size_t head) noexcept {
+    if constexpr (prefetch_distance != 0) {
+      const auto ahead = head + prefetch_distance;
+      if (prefetch_distance < consumer_.tail_cache - head) {
+        detail::prefetch_lines<false>(slot(consumer_, ahead));
+      }
+    }
+  }
+
+  // Producer: slots [first, first + count) have been written
+  void hint_written(std::size_t first, std::size_t count) noexcept {
+    if constexpr (publish_hint == CacheHint::demote) {
+      for (std::size_t i = 0; i < count; ++i) {
+        detail::demote_lines(slot(producer_, first + i));
+      }
+    }
+    prefetch_for_push(first + count);
+  }
+
+  void on_full() noexcept {
+    instr_.on_full();
+    flush();
+  }
+
+  void on_empty() noexcept { flush_consumer(); }
+
+  // Producer-owned and only touched when head_ is reloaded. Declared after
+  // head_, so it gets a line of its own rather than sharing the one the
+  // consumer writes on every publish.
+  struct alignas(detail::cache_line_size) watermark_state {
+    std::size_t high{0};  ///< 0 while no watermarks are set
+    std::size_t low{0};
+    bool above{false};  ///< Reached high and not yet back down to low
+    std::function<void(Watermark, std::size_t)> callback;
+  };
+  watermark_state watermarks_;
+
+  // The producer reloads head_ once its cached occupancy, an upper bound of
+  // the real one, would pass producer_.refresh_at. That is the capacity
+  // without watermarks, so only a seemingly full buffer pays for the load.
+  // Below the high watermark it is lowered to the high watermark, and above
+  // it to 0, so the fall to the low watermark is seen on the next push.
+  void refresh_head() noexcept {
+    producer_.head_cache = head_.load(std::memory_order_acquire);
+    instr_.on_head_refresh();
+    if (watermarks_.high != 0) {
+      check_watermarks();
+    }
+  }
+
+  void check_watermarks() noexcept {
+    const auto occupancy = producer_.tail - producer_.head_cache;
+    if (!watermarks_.above && occupancy >= watermarks_.high) {
+      watermarks_.above = true;
+      producer_.refresh_at = 0;
+      if (watermarks_.callback) {
+        watermarks_.callback(Watermark::high, occupancy);
+      }
+    } else if (watermarks_.above && occupancy <= watermarks_.low) {
+      watermarks_.above = false;
+      producer_.refresh_at = watermarks_.high;
+      if (watermarks_.callback) {
+        watermarks_.callback(Watermark::low, occupancy);
+      }
+    }
+  }
+
+  // Set by a blocking call that is about to park, so the other side only pays
+  // for a notify while someone is actually asleep
+  alignas(detail::cache_line_size) std::atomic<bool> producer_waiting_{false};
+  std::atomic<bool> consumer_waiting_{false};
+
+  // Parking is a store-buffering handshake: the sleeper stores its flag and
+  // then re-reads the index, both seq_cst; the waker stores the index, issues
+  // a seq_cst fence and then reads the flag. At least one of them sees the
+  // other, and std::atomic::wait re-checks the index so no wakeup is lost.
+  void park_producer() noexcept {
+    const auto full_head = producer_.tail - capacity(producer_);
+    producer_waiting_.store(true, std::memory_order_seq_cst);
+    if (head_.load(std::memory_order_seq_cst) == full_head) {
+      head_.wait(full_head, std::memory_order_acquire);
+    }
+    producer_waiting_.store(false, std::memory_order_relaxed);
+  }
+
+  void park_consumer() noexcept {
+    const auto empty_tail = consumer_.head;
+    consumer_waiting_.store(true, std::memory_order_seq_cst);
+    if (tail_.load(std::memory_order_seq_cst) == empty_tail) {
+      tail_.wait(empty_tail, std::memory_order_acquire);
+    }
+    consumer_waiting_.store(false, std::memory_order_relaxed);
+  }
+
+  // Called right after storing tail_ or head_; the fence orders that store
+  // before the flag load, and the notify syscall is only made for a sleeper
+  void wake_consumer() noexcept {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (consumer_waiting_.load(std::memory_order_relaxed)) {
+      tail_.notify_one();
+    }
+  }
+
+  void wake_producer() noexcept {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (producer_waiting_.load(std::memory_order_relaxed)) {
+      head_.notify_one();
+    }
+  }
+
+  // Called by the blocking calls after their publish, which only woke the
+  // other side with Traits::blocking. With lazy publication a sleeper may be
+  // waiting for an index that has not been published yet, so it is published
+  // early for a sleeper. A sleeper that raced with an unpublished try_* push
+  // is woken by the next flush() instead.
+  void notify_consumer() noexcept {
+    if constexpr (!blocking || publish_interval != 1) {
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (consumer_waiting_.load(std::memory_order_relaxed)) {
+        (void)publish_pending_tail();
+        tail_.notify_one();
+      }
+    }
+  }
+
+  void notify_producer() noexcept {
+    if constexpr (!blocking || publish_interval != 1) {
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (producer_waiting_.load(std::memory_order_relaxed)) {
+        (void)publish_pending_head();
+        head_.notify_one();
+      }
+    }
+  }
 
  public:
   using value_type = T;
   using size_type = std::size_t;
+  using allocator_type = Allocator;
+  using traits_type = Traits;
+
+  /**
+   * @brief Up to two contiguous views of the buffer, split at the wrap point
+   */
+  struct span_pair {
+    std::span<T> first;   ///< Slots up to the end of the internal buffer
+    std::span<T> second;  ///< Slots wrapped around to the start of the buffer
+
+    [[nodiscard]] size_type size() const noexcept {
+      return first.size() + second.size();
+    }
+    [[nodiscard]] bool empty() const noexcept { return first.empty(); }
+  };
+
+  /**
+   * @brief Both published indices as they were at one instant
+   */
+  struct occupancy_snapshot {
+    std::uint64_t pushed;  ///< Elements published by the producer so far
+    std::uint64_t popped;  ///< Elements released by the consumer so far
+
+    [[nodiscard]] size_type size() const noexcept {
+      return static_cast<size_type>(pushed - popped);
+    }
+  };
 
   /**
    * @brief Constructs a ring buffer with the specified capacity
-   * @param capacity Desired capacity (will be rounded up to power of 2, min 2)
+   * @param capacity Desired capacity (will be rounded up to power of 2, min 1)
+   * @param alloc Allocator for the slot array
    * @throws std::bad_alloc If memory allocation fails
+   * @note Slots are left uninitialized; elements are constructed on push and
+   *       destroyed on pop, so T need not be default constructible
    */
-  explicit SPSCRingBuffer(size_type capacity)
-      : capacity_(next_power_of_2(capacity > 1 ? capacity : 2)),
-        index_mask_(capacity_ - 1),
-        buffer_(new T[capacity_]) {}
+  explicit SPSCRingBuffer(size_type capacity,
+                          const Allocator& alloc = Allocator())
+    requires(Capacity == dynamic_capacity)
+      : storage_(capacity, alloc), instr_(storage_.capacity()) {}
+
+  /**
+   * @brief Constructs a ring buffer with the compile-time capacity
+   * @note Slots are left uninitialized, as with the dynamic constructor
+   */
+  SPSCRingBuffer() noexcept(
+      std::is_nothrow_constructible_v<instrumentation_type, size_type>)
+    requires(Capacity != dynamic_capacity)
+      : instr_(storage_.capacity()) {}
+
+  /**
+   * @brief Constructs a ring buffer with the compile-time capacity
+   * @param alloc Allocator used to construct and destroy elements
+   */
+  explicit SPSCRingBuffer(const Allocator& alloc) noexcept(
+      std::is_nothrow_constructible_v<instrumentation_type, size_type>)
+    requires(Capacity != dynamic_capacity)
+      : storage_(alloc), instr_(storage_.capacity()) {}
 
   /**
    * @brief Destructor
+   * @note Destroys any elements still in the buffer
    */
-  ~SPSCRingBuffer() { delete[] buffer_; }
+  ~SPSCRingBuffer() {
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      auto head = consumer_.head;
+      const auto tail = producer_.tail;
+      for (; head != tail; ++head) {
+        destroy(slot(consumer_, head));
+      }
+    }
+  }
 
   // Non-copyable and non-movable for safety
   SPSCRingBuffer(const SPSCRingBuffer&) = delete;
@@ -120,29 +959,43 @@ class SPSCRingBuffer {
   SPSCRingBuffer& operator=(SPSCRingBuffer&&) = delete;
 
   /**
-   * @brief Attempt to push an element (copy version)
-   * @param item The element to add to the buffer
+   * @brief Attempt to construct an element in place
+   * @param args Arguments forwarded to the constructor of T
    * @return true if the element was successfully added, false if buffer full
    * @note This function should only be called from the producer thread
    */
-  [[nodiscard]] bool try_push(const T& item) noexcept(
-      std::is_nothrow_copy_assignable_v<T>) {
-    const auto current_tail = tail_.load(std::memory_order_relaxed);
-    const auto next_tail = (current_tail + 1) & index_mask_;
+  template <typename... Args>
+  [[nodiscard]] bool try_emplace(Args&&... args) noexcept(
+      std::is_nothrow_constructible_v<T, Args&&...>) {
+    const auto current_tail = producer_.tail;
 
-    if (next_tail == head_cache_) {
-      head_cache_ = head_.load(std::memory_order_acquire);
-      if (next_tail == head_cache_) {
+    if (current_tail - producer_.head_cache >= producer_.refresh_at) {
+      refresh_head();
+      if (current_tail - producer_.head_cache == capacity(producer_)) {
+        on_full();
         return false;
       }
     }
 
-    buffer_[current_tail] = item;
+    construct(slot(producer_, current_tail), std::forward<Args>(args)...);
 
-    tail_.store(next_tail, std::memory_order_release);
+    hint_written(current_tail, 1);
+    instr_.on_publish(current_tail, 1);
+    publish_tail(current_tail + 1);
     return true;
   }
 
+  /**
+   * @brief Attempt to push an element (copy version)
+   * @param item The element to add to the buffer
+   * @return true if the element was successfully added, false if buffer full
+   * @note This function should only be called from the producer thread
+   */
+  [[nodiscard]] bool try_push(const T& item) noexcept(
+      std::is_nothrow_copy_constructible_v<T>) {
+    return try_emplace(item);
+  }
+
   /**
    * @brief Attempt to push an element (move version)
    * @param item The element to move into the buffer
@@ -150,21 +1003,202 @@ class SPSCRingBuffer {
    * @note This function should only be called from the producer thread
    */
   [[nodiscard]] bool try_push(T&& item) noexcept(
-      std::is_nothrow_move_assignable_v<T>) {
-    const auto current_tail = tail_.load(std::memory_order_relaxed);
-    const auto next_tail = (current_tail + 1) & index_mask_;
+      std::is_nothrow_move_constructible_v<T>) {
+    return try_emplace(std::move(item));
+  }
 
-    if (next_tail == head_cache_) {
-      head_cache_ = head_.load(std::memory_order_acquire);
-      if (next_tail == head_cache_) {
-        return false;
+  /**
+   * @brief Attempt to push a range of elements with a single publish
+   * @param first Iterator to the first element to push
+   * @param last Sentinel past the last element to push
+   * @return The number of elements pushed, which is less than
+   *         std::ranges::distance(first, last) if the buffer fills up
+   * @note This function should only be called from the producer thread
+   * @note Elements are constructed from *first, in a single pass. The range
+   *       must be a forward range or have a sized sentinel, so wrapping a
+   *       random-access range in std::make_move_iterator moves them.
+   * @note A contiguous range of trivially copyable T is copied with one
+   *       memcpy per wrap segment
+   */
+  template <std::input_iterator It, std::sentinel_for<It> S>
+    requires(std::forward_iterator<It> || std::sized_sentinel_for<S, It>)
+  [[nodiscard]] size_type try_push_n(It first, S last) noexcept(
+      std::is_nothrow_constructible_v<T, std::iter_reference_t<It>>) {
+    const auto current_tail = producer_.tail;
+    const auto requested =
+        static_cast<size_type>(std::ranges::distance(first, last));
+
+    auto available =
+        capacity(producer_) - (current_tail - producer_.head_cache);
+    if (current_tail - producer_.head_cache + requested >
+        producer_.refresh_at) {
+      refresh_head();
+      available = capacity(producer_) - (current_tail - producer_.head_cache);
+    }
+
+    const auto count = std::min(requested, available);
+    if (count == 0) {
+      if (requested != 0) {
+        on_full();
       }
+      return 0;
     }
 
-    buffer_[current_tail] = std::move(item);
+    size_type constructed = 0;
+    const auto construct_all = [&] {
+      if constexpr (bulk_copyable<It>) {
+        const auto offset = current_tail & index_mask(producer_);
+        const auto first_segment =
+            std::min(count, capacity(producer_) - offset);
+        const T* src = std::to_address(first);
+        detail::copy_elements(slots(producer_) + offset, src, first_segment);
+        detail::copy_elements(slots(producer_), src + first_segment,
+                              count - first_segment);
+      } else if constexpr (slot_layout == SlotLayout::contiguous) {
+        // At most two contiguous segments: [tail, end of buffer) then [0, rest)
+        const auto offset = current_tail & index_mask(producer_);
+        const auto first_segment =
+            std::min(count, capacity(producer_) - offset);
+        const auto construct_segment = [&](T* dst, size_type n) {
+          for (size_type i = 0; i < n; ++i, ++first, ++constructed) {
+            construct(dst + i, *first);
+          }
+        };
+        construct_segment(slots(producer_) + offset, first_segment);
+        construct_segment(slots(producer_), count - first_segment);
+      } else {
+        for (; constructed < count; ++first, ++constructed) {
+          construct(slot(producer_, current_tail + constructed), *first);
+        }
+      }
+    };
+    if constexpr (std::is_nothrow_constructible_v<T,
+                                                  std::iter_reference_t<It>>) {
+      construct_all();
+    } else {
+      try {
+        construct_all();
+      } catch (...) {
+        for (size_type i = 0; i < constructed; ++i) {
+          destroy(slot(producer_, current_tail + i));
+        }
+        throw;
+      }
+    }
 
-    tail_.store(next_tail, std::memory_order_release);
-    return true;
+    hint_written(current_tail, count);
+    instr_.on_publish(current_tail, count);
+    publish_tail(current_tail + count);
+    return count;
+  }
+
+  /**
+   * @brief Attempt to push a contiguous batch of elements
+   * @param items The elements to copy into the buffer
+   * @return The number of elements pushed, which is less than items.size()
+   *         if the buffer fills up
+   * @note This function should only be called from the producer thread
+   */
+  [[nodiscard]] size_type try_push_n(std::span<const T> items) noexcept(
+      std::is_nothrow_copy_constructible_v<T>) {
+    return try_push_n(items.begin(), items.end());
+  }
+
+  /**
+   * @brief Reserve the next slot for in-place writing
+   * @return Pointer to the uninitialized slot at the tail, or nullptr if
+   *         buffer full
+   * @note This function should only be called from the producer thread
+   * @note The slot is not visible to the consumer until commit() is called;
+   *       calling try_reserve() again before that returns the same slot
+   * @warning The slot holds no object. Unless T is an implicit-lifetime type
+   *          (e.g. a trivially copyable struct), construct it in place with
+   *          std::construct_at before calling commit()
+   */
+  [[nodiscard]] T* try_reserve() noexcept {
+    const auto current_tail = producer_.tail;
+
+    if (current_tail - producer_.head_cache >= producer_.refresh_at) {
+      refresh_head();
+      if (current_tail - producer_.head_cache == capacity(producer_)) {
+        on_full();
+        return nullptr;
+      }
+    }
+
+    return slot(producer_, current_tail);
+  }
+
+  /**
+   * @brief Publish the slot obtained from try_reserve()
+   * @note This function should only be called from the producer thread
+   * @warning Calling commit() without a successful try_reserve() is undefined
+   *          behavior
+   */
+  void commit() noexcept { commit_n(1); }
+
+  /**
+   * @brief Reserve up to max_count slots for in-place writing
+   * @param max_count Maximum number of slots to reserve
+   * @return Up to two spans covering the reserved slots in FIFO order;
+   *         both are empty if the buffer is full
+   * @note This function should only be called from the producer thread
+   * @note The slots are not visible to the consumer until commit_n() is called
+   * @warning As with try_reserve(), the slots are uninitialized storage
+   * @note Only available with SlotLayout::contiguous
+   */
+  [[nodiscard]] span_pair reserve_n(size_type max_count) noexcept
+    requires(slot_layout == SlotLayout::contiguous)
+  {
+    const auto current_tail = producer_.tail;
+
+    auto available =
+        capacity(producer_) - (current_tail - producer_.head_cache);
+    if (current_tail - producer_.head_cache + max_count >
+        producer_.refresh_at) {
+      refresh_head();
+      available = capacity(producer_) - (current_tail - producer_.head_cache);
+      if (available == 0) {
+        on_full();
+      }
+    }
+
+    const auto count = std::min(available, max_count);
+    const auto offset = current_tail & index_mask(producer_);
+    const auto first_segment = std::min(count, capacity(producer_) - offset);
+    return {{slots(producer_) + offset, first_segment},
+            {slots(producer_), count - first_segment}};
+  }
+
+  /**
+   * @brief Publish the first count slots obtained from reserve_n()
+   * @param count Number of reserved slots to publish
+   * @note This function should only be called from the producer thread
+   * @warning count must not exceed the number of slots last reserved
+   */
+  void commit_n(size_type count) noexcept {
+    const auto current_tail = producer_.tail;
+    assert(count + (current_tail - head_.load(std::memory_order_relaxed)) <=
+               capacity(producer_) &&
+           "commit_n() called with more slots than reserved");
+    hint_written(current_tail, count);
+    instr_.on_publish(current_tail, count);
+    publish_tail(current_tail + count);
+  }
+
+  /**
+   * @brief Publish every element pushed so far to the consumer
+   * @note This function should only be called from the producer thread
+   * @note Only needed with Traits::publish_interval above 1, where pushes
+   *       publish tail_ every publish_interval elements; call it at the end
+   *       of a burst to bound the latency of its last elements
+   * @note Also wakes a consumer parked in pop_wait(), which may be waiting
+   *       for exactly these elements
+   */
+  void flush() noexcept {
+    if (publish_pending_tail()) {
+      wake_consumer();
+    }
   }
 
   /**
@@ -174,28 +1208,97 @@ class SPSCRingBuffer {
    * @note You must call pop() after processing the element
    */
   [[nodiscard]] T* front() noexcept {
-    const auto current_head = head_.load(std::memory_order_relaxed);
+    const auto current_head = consumer_.head;
 
-    if (current_head == tail_cache_) {
-      tail_cache_ = tail_.load(std::memory_order_acquire);
-      if (current_head == tail_cache_) {
+    if (current_head == consumer_.tail_cache) {
+      consumer_.tail_cache = tail_.load(std::memory_order_acquire);
+      instr_.on_tail_refresh(consumer_.tail_cache - current_head);
+      if (current_head == consumer_.tail_cache) {
+        on_empty();
         return nullptr;
       }
     }
 
-    return &buffer_[current_head];
+    return slot(consumer_, current_head);
   }
 
   /**
-   * @brief Remove the front element
+   * @brief Remove and destroy the front element
    * @note This function should only be called from the consumer thread
    * @warning Calling pop() on an empty buffer is undefined behavior
    */
   void pop() noexcept {
-    const auto current_head = head_.load(std::memory_order_relaxed);
+    const auto current_head = consumer_.head;
     assert(current_head != tail_.load(std::memory_order_relaxed) &&
            "pop() called on empty buffer");
-    head_.store((current_head + 1) & index_mask_, std::memory_order_release);
+    destroy(slot(consumer_, current_head));
+    instr_.on_consume(current_head, 1);
+    prefetch_for_pop(current_head + 1);
+    publish_head(current_head + 1);
+  }
+
+  /**
+   * @brief Get views of up to max_count front elements without removing them
+   * @param max_count Maximum number of elements to expose
+   * @return Up to two spans covering the readable elements in FIFO order;
+   *         both are empty if the buffer is empty
+   * @note This function should only be called from the consumer thread
+   * @note You must call pop_n() after processing the elements
+   * @note Only available with SlotLayout::contiguous
+   */
+  [[nodiscard]] span_pair front_n(size_type max_count) noexcept
+    requires(slot_layout == SlotLayout::contiguous)
+  {
+    const auto current_head = consumer_.head;
+
+    auto readable = consumer_.tail_cache - current_head;
+    if (readable < max_count) {
+      consumer_.tail_cache = tail_.load(std::memory_order_acquire);
+      readable = consumer_.tail_cache - current_head;
+      instr_.on_tail_refresh(readable);
+      if (readable == 0) {
+        on_empty();
+      }
+    }
+
+    const auto count = std::min(readable, max_count);
+    const auto offset = current_head & index_mask(consumer_);
+    const auto first_segment = std::min(count, capacity(consumer_) - offset);
+    return {{slots(consumer_) + offset, first_segment},
+            {slots(consumer_), count - first_segment}};
+  }
+
+  /**
+   * @brief Get views of every element currently readable
+   * @return Up to two spans covering the readable elements in FIFO order
+   * @note This function should only be called from the consumer thread
+   * @note You must call pop_n() after processing the elements
+   * @note Only available with SlotLayout::contiguous
+   */
+  [[nodiscard]] span_pair read_available() noexcept
+    requires(slot_layout == SlotLayout::contiguous)
+  {
+    return front_n(capacity());
+  }
+
+  /**
+   * @brief Remove and destroy the count front elements with a single publish
+   * @param count Number of elements to remove
+   * @note This function should only be called from the consumer thread
+   * @warning count must not exceed the number of readable elements
+   */
+  void pop_n(size_type count) noexcept {
+    const auto current_head = consumer_.head;
+    assert(count <= tail_.load(std::memory_order_relaxed) - current_head &&
+           "pop_n() called with more elements than available");
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      for (size_type i = 0; i < count; ++i) {
+        destroy(slot(consumer_, current_head + i));
+      }
+    }
+    instr_.on_consume(current_head, count);
+    prefetch_for_pop(current_head + count);
+    publish_head(current_head + count);
   }
 
   /**
@@ -207,21 +1310,282 @@ class SPSCRingBuffer {
    */
   [[nodiscard]] std::optional<T> try_pop() noexcept(
       std::is_nothrow_move_constructible_v<T>) {
-    const auto current_head = head_.load(std::memory_order_relaxed);
+    const auto current_head = consumer_.head;
 
-    if (current_head == tail_cache_) {
-      tail_cache_ = tail_.load(std::memory_order_acquire);
-      if (current_head == tail_cache_) {
+    if (current_head == consumer_.tail_cache) {
+      consumer_.tail_cache = tail_.load(std::memory_order_acquire);
+      instr_.on_tail_refresh(consumer_.tail_cache - current_head);
+      if (current_head == consumer_.tail_cache) {
+        on_empty();
         return std::nullopt;
       }
     }
 
-    T item = std::move(buffer_[current_head]);
+    T* item_slot = slot(consumer_, current_head);
+    T item = std::move(*item_slot);
+    destroy(item_slot);
 
-    head_.store((current_head + 1) & index_mask_, std::memory_order_release);
+    instr_.on_consume(current_head, 1);
+    prefetch_for_pop(current_head + 1);
+    publish_head(current_head + 1);
     return item;
   }
 
+  /**
+   * @brief Attempt to pop up to out.size() elements with a single publish
+   * @param out Destination for the popped elements, in FIFO order
+   * @return The number of elements popped into the front of out
+   * @note This function should only be called from the consumer thread
+   * @note Elements are move-assigned to out; trivially copyable T is copied
+   *       with one memcpy per wrap segment
+   * @note Only available with SlotLayout::contiguous
+   */
+  [[nodiscard]] size_type try_pop_n(std::span<T> out) noexcept(
+      std::is_nothrow_move_assignable_v<T>)
+    requires(slot_layout == SlotLayout::contiguous)
+  {
+    const auto batch = front_n(out.size());
+    if constexpr (std::is_trivially_copyable_v<T>) {
+      detail::copy_elements(out.data(), batch.first.data(),
+                            batch.first.size());
+      detail::copy_elements(out.data() + batch.first.size(),
+                            batch.second.data(), batch.second.size());
+    } else {
+      auto dst = std::move(batch.first.begin(), batch.first.end(),
+                           out.begin());
+      std::move(batch.second.begin(), batch.second.end(), dst);
+    }
+    pop_n(batch.size());
+    return batch.size();
+  }
+
+  /**
+   * @brief Hand the readable elements to f in place, then pop them
+   * @param f Callable invoked as f(std::span<T>) once per wrap segment, so
+   *        at most twice; it may read or modify the elements, e.g. convert
+   *        a batch of prices in one vectorizable loop
+   * @param max_count Maximum number of elements to process
+   * @return The number of elements processed and popped
+   * @note This function should only be called from the consumer thread
+   * @note If f throws, nothing is popped and every element stays readable
+   * @note Only available with SlotLayout::contiguous
+   */
+  template <typename F>
+    requires std::invocable<F&, std::span<T>>
+  size_type drain(F&& f,
+                  size_type max_count = std::numeric_limits<size_type>::max())
+    requires(slot_layout == SlotLayout::contiguous)
+  {
+    const auto batch = front_n(max_count);
+    if (batch.empty()) {
+      return 0;
+    }
+    f(batch.first);
+    if (!batch.second.empty()) {
+      f(batch.second);
+    }
+    pop_n(batch.size());
+    return batch.size();
+  }
+
+  /**
+   * @brief Release every slot popped so far to the producer
+   * @note This function should only be called from the consumer thread
+   * @note Only needed with Traits::publish_interval above 1; the consumer
+   *       also releases its pops whenever it finds the buffer empty
+   * @note Also wakes a producer parked in push()
+   */
+  void flush_consumer() noexcept {
+    if (publish_pending_head()) {
+      wake_producer();
+    }
+  }
+
+  /**
+   * @brief Report occupancy crossing a high and a low watermark
+   * @param high Occupancy at which callback(Watermark::high, occupancy) is
+   *        invoked, between 1 and capacity()
+   * @param low Occupancy at which callback(Watermark::low, occupancy) is
+   *        invoked once the high watermark was reached, below high
+   * @param callback Invoked on the producer thread from inside the push that
+   *        observes the crossing; it must not throw or push to this buffer
+   * @note This function should only be called from the producer thread
+   * @note Occupancy is evaluated whenever the producer reloads the consumer's
+   *       index, which it does once its cached view reaches the high
+   *       watermark instead of only when the buffer looks full, and on every
+   *       push while above it. Both events are thus reported by the first
+   *       push after the crossing, at the cost of a load of the consumer's
+   *       index per push while occupancy is at or near the high watermark.
+   */
+  void set_watermarks(size_type high, size_type low,
+                      std::function<void(Watermark, size_type)> callback) {
+    assert(low < high && high <= capacity() &&
+           "watermarks need 0 <= low < high <= capacity()");
+    watermarks_.high = high;
+    watermarks_.low = low;
+    watermarks_.above = false;
+    watermarks_.callback = std::move(callback);
+    producer_.refresh_at = high;
+  }
+
+  /**
+   * @brief Stop reporting watermark crossings
+   * @note This function should only be called from the producer thread
+   */
+  void clear_watermarks() noexcept {
+    watermarks_ = {};
+    producer_.refresh_at = capacity(producer_);
+  }
+
+  /**
+   * @brief Check whether occupancy is at or above the high watermark
+   * @return true from the push that saw the high watermark reached until
+   *         occupancy is seen back at or below the low watermark
+   * @note This function should only be called from the producer thread
+   * @note While above, this reloads the consumer's index, so a producer that
+   *       sheds load instead of pushing still sees the fall to the low
+   *       watermark (and the callback runs from here)
+   */
+  [[nodiscard]] bool above_high_watermark() noexcept {
+    if (watermarks_.above) {
+      refresh_head();
+    }
+    return watermarks_.above;
+  }
+
+  /**
+   * @brief Construct an element in place, waiting while the buffer is full
+   * @param args Arguments forwarded to the constructor of T
+   * @note This function should only be called from the producer thread
+   * @note Spins briefly, then sleeps in std::atomic::wait until the consumer
+   *       frees a slot. Only the consumer's blocking calls (pop_wait(),
+   *       try_pop_until(), try_pop_for()) wake a parked producer, unless
+   *       Traits::blocking makes every consumer publish do so. Either way the
+   *       notify is only issued while the producer is actually parked.
+   */
+  template <typename... Args>
+  void emplace(Args&&... args) {
+    detail::spin_wait spinner;
+    while (!try_emplace(std::forward<Args>(args)...)) {
+      if (!spinner.once()) {
+        park_producer();
+      }
+    }
+    notify_consumer();
+  }
+
+  /**
+   * @brief Push an element, waiting while the buffer is full (copy version)
+   * @param item The element to add to the buffer
+   * @note This function should only be called from the producer thread
+   * @note See emplace() for how the wait is performed
+   */
+  void push(const T& item) { emplace(item); }
+
+  /**
+   * @brief Push an element, waiting while the buffer is full (move version)
+   * @param item The element to move into the buffer
+   * @note This function should only be called from the producer thread
+   * @note See emplace() for how the wait is performed
+   */
+  void push(T&& item) { emplace(std::move(item)); }
+
+  /**
+   * @brief Push an element, waiting until a deadline while the buffer is full
+   * @param item The element to add to the buffer
+   * @param deadline Time point after which to give up
+   * @return true if the element was added, false if the deadline passed
+   * @note This function should only be called from the producer thread
+   * @note std::atomic::wait has no timeout, so after spinning this sleeps in
+   *       growing steps of at most 100us instead of parking
+   */
+  template <typename U, typename Clock, typename Duration>
+    requires std::constructible_from<T, U&&>
+  [[nodiscard]] bool try_push_until(
+      U&& item, const std::chrono::time_point<Clock, Duration>& deadline) {
+    detail::timed_wait waiter(deadline);
+    while (!try_emplace(std::forward<U>(item))) {
+      if (!waiter.once()) {
+        return false;
+      }
+    }
+    notify_consumer();
+    return true;
+  }
+
+  /**
+   * @brief Push an element, waiting up to a timeout while the buffer is full
+   * @param item The element to add to the buffer
+   * @param timeout Maximum time to wait
+   * @return true if the element was added, false if the timeout expired
+   * @note This function should only be called from the producer thread
+   */
+  template <typename U, typename Rep, typename Period>
+    requires std::constructible_from<T, U&&>
+  [[nodiscard]] bool try_push_for(
+      U&& item, const std::chrono::duration<Rep, Period>& timeout) {
+    return try_push_until(std::forward<U>(item),
+                          std::chrono::steady_clock::now() + timeout);
+  }
+
+  /**
+   * @brief Pop an element, waiting while the buffer is empty
+   * @return The popped element
+   * @note This function should only be called from the consumer thread
+   * @note Spins briefly, then sleeps in std::atomic::wait until the producer
+   *       publishes. Only the producer's blocking calls (push(), emplace(),
+   *       try_push_until(), try_push_for()) wake a parked consumer, unless
+   *       Traits::blocking is set, as for emplace().
+   */
+  [[nodiscard]] T pop_wait() {
+    detail::spin_wait spinner;
+    for (;;) {
+      if (auto item = try_pop()) {
+        notify_producer();
+        return std::move(*item);
+      }
+      if (!spinner.once()) {
+        park_consumer();
+      }
+    }
+  }
+
+  /**
+   * @brief Pop an element, waiting until a deadline while the buffer is empty
+   * @param deadline Time point after which to give up
+   * @return std::optional containing the popped element, or std::nullopt if
+   *         the deadline passed
+   * @note This function should only be called from the consumer thread
+   * @note Sleeps in capped steps rather than parking, as try_push_until()
+   */
+  template <typename Clock, typename Duration>
+  [[nodiscard]] std::optional<T> try_pop_until(
+      const std::chrono::time_point<Clock, Duration>& deadline) {
+    detail::timed_wait waiter(deadline);
+    for (;;) {
+      if (auto item = try_pop()) {
+        notify_producer();
+        return item;
+      }
+      if (!waiter.once()) {
+        return std::nullopt;
+      }
+    }
+  }
+
+  /**
+   * @brief Pop an element, waiting up to a timeout while the buffer is empty
+   * @param timeout Maximum time to wait
+   * @return std::optional containing the popped element, or std::nullopt if
+   *         the timeout expired
+   * @note This function should only be called from the consumer thread
+   */
+  template <typename Rep, typename Period>
+  [[nodiscard]] std::optional<T> try_pop_for(
+      const std::chrono::duration<Rep, Period>& timeout) {
+    return try_pop_until(std::chrono::steady_clock::now() + timeout);
+  }
+
   /**
    * @brief Check if the buffer appears empty
    * @return true if the buffer appears empty at the time of the call
@@ -239,32 +1603,71 @@ class SPSCRingBuffer {
    * @note This is an approximate check due to concurrent access. The state
    *       may change immediately after this function returns.
    */
-  [[nodiscard]] bool full() const noexcept {
-    const auto next_tail =
-        (tail_.load(std::memory_order_relaxed) + 1) & index_mask_;
-    return next_tail == head_.load(std::memory_order_relaxed);
-  }
+  [[nodiscard]] bool full() const noexcept { return size() == capacity(); }
 
   /**
    * @brief Get the approximate current size
    * @return The approximate number of elements currently in the buffer
    * @note This is an approximate value due to concurrent access. The actual
-   *       size may change immediately after this function returns.
+   *       size may change immediately after this function returns. Use
+   *       occupancy() for an exact value.
    */
   [[nodiscard]] size_type size() const noexcept {
-    const auto head = head_.load(std::memory_order_relaxed);
+    // Loading head_ first with acquire guarantees the later tail_ load is not
+    // behind it; tail_ may have run ahead since, so clamp to the capacity.
+    const auto head = head_.load(std::memory_order_acquire);
     const auto tail = tail_.load(std::memory_order_relaxed);
-    return (tail - head) & index_mask_;
+    return std::min(tail - head, capacity());
+  }
+
+  /**
+   * @brief Get the number of elements the producer has published
+   * @return Monotonic count since construction, i.e. the published tail
+   * @note May be called from any thread. With Traits::publish_interval above
+   *       1, elements pushed since the last publish are not counted yet.
+   */
+  [[nodiscard]] std::uint64_t pushed_count() const noexcept {
+    return tail_.load(std::memory_order_acquire);
+  }
+
+  /**
+   * @brief Get the number of elements the consumer has released
+   * @return Monotonic count since construction, i.e. the published head
+   * @note May be called from any thread, with the same caveat as
+   *       pushed_count() for lazy publication
+   */
+  [[nodiscard]] std::uint64_t popped_count() const noexcept {
+    return head_.load(std::memory_order_acquire);
+  }
+
+  /**
+   * @brief Get a consistent snapshot of both published indices
+   * @return Counts such that pushed - popped was the exact number of
+   *         published, unreleased elements at one instant during the call
+   * @note May be called from any thread. The consumer's index is read on
+   *       both sides of the producer's and the pair retried until it did not
+   *       move, so this costs at least three loads of shared lines.
+   */
+  [[nodiscard]] occupancy_snapshot occupancy() const noexcept {
+    auto head = head_.load(std::memory_order_acquire);
+    for (;;) {
+      const auto tail = tail_.load(std::memory_order_acquire);
+      const auto head_after = head_.load(std::memory_order_acquire);
+      // head_ did not move while tail_ was read, so both held at that load
+      if (head_after == head) {
+        return {tail, head};
+      }
+      head = head_after;
+    }
   }
 
   /**
    * @brief Get the maximum capacity
-   * @return The maximum number of elements this buffer can hold
-   * @note Due to the implementation keeping one slot empty, this returns
-   *       capacity_ - 1, which is the actual usable capacity.
+   * @return The maximum number of elements this buffer can hold, which is
+   *         every slot of the internal buffer
    */
   [[nodiscard]] size_type capacity() const noexcept {
-    return capacity_ - 1;  // One slot kept empty for empty/full distinction
+    return storage_.capacity();
   }
 
   /**
@@ -272,7 +1675,25 @@ class SPSCRingBuffer {
    * @return The total number of slots in the internal buffer
    * @note This is primarily for debugging/testing purposes.
    */
-  [[nodiscard]] size_type buffer_size() const noexcept { return capacity_; }
+  [[nodiscard]] size_type buffer_size() const noexcept {
+    return storage_.capacity();
+  }
+
+  /**
+   * @brief Get a copy of the allocator
+   * @return The allocator used for the slots
+   */
+  [[nodiscard]] allocator_type get_allocator() const noexcept {
+    return storage_.allocator();
+  }
+
+  /**
+   * @brief Access the instrumentation policy
+   * @return The object receiving the hot-path hooks, e.g. to read counters
+   */
+  [[nodiscard]] const instrumentation_type& instrumentation() const noexcept {
+    return instr_;
+  }
 };
 
 }  // namespace fadli
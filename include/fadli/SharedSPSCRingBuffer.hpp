@@ -0,0 +1,450 @@
+/**
+ * @file SharedSPSCRingBuffer.hpp
+ * @brief A lock-free spsc ring buffer living in POSIX shared memory.
+ * @author Fadli Arsani <fadlialim0029@gmail.com>
+ * @version 1.0.0
+ *
+ * MIT License
+ *
+ * Copyright (c) 2025 Fadli Arsani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+
+#include "SPSCRingBuffer.hpp"
+
+namespace fadli {
+
+/**
+ * @brief Tag selecting the constructor that creates a new shared region
+ */
+struct create_shared_t {
+  explicit create_shared_t() = default;
+};
+inline constexpr create_shared_t create_shared{};
+
+/**
+ * @brief Tag selecting the constructor that attaches to an existing region
+ */
+struct attach_shared_t {
+  explicit attach_shared_t() = default;
+};
+inline constexpr attach_shared_t attach_shared{};
+
+namespace detail {
+
+/**
+ * @brief Header at the start of the shared region
+ *
+ * Only offsets and plain integers live here so the region can be mapped at
+ * different addresses in each process. magic is written last by the creator
+ * and doubles as the "initialized" flag.
+ */
+struct shared_ring_header {
+  // "fadliSPS" in ASCII
+  static constexpr std::uint64_t expected_magic = 0x6661646c69535053;
+  static constexpr std::uint32_t current_version = 1;
+
+  std::atomic<std::uint64_t> magic;
+  std::uint32_t version;
+  std::uint32_t header_size;
+  std::uint64_t element_size;
+  std::uint64_t element_alignment;
+  std::uint64_t capacity;      ///< Number of slots (power of 2)
+  std::uint64_t slots_offset;  ///< Byte offset of the slot array
+
+  // Monotonic indices, on separate cache lines as in SPSCRingBuffer
+  alignas(cache_line_size) std::atomic<std::uint64_t> head;
+  alignas(cache_line_size) std::atomic<std::uint64_t> tail;
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+              "Shared indices require lock-free 64-bit atomics");
+
+}  // namespace detail
+
+/**
+ * @brief Single-producer single-consumer ring buffer shared between processes
+ * @tparam T The type of elements stored; must be trivially copyable since the
+ *         bytes are read by another process
+ * @warning One process (or thread) must produce and one must consume.
+ * @code
+ * // Feed handler process
+ * fadli::SharedSPSCRingBuffer<Tick> out(fadli::create_shared, "/ticks", 65536);
+ * while (!out.try_push(tick));
+ *
+ * // Strategy process
+ * fadli::SharedSPSCRingBuffer<Tick> in(fadli::attach_shared, "/ticks");
+ * while (auto* tick = in.front()) {
+ *     process(*tick);
+ *     in.pop();
+ * }
+ * @endcode
+ */
+template <typename T>
+class SharedSPSCRingBuffer {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "T must be trivially copyable to be shared across processes");
+
+ private:
+  using header_type = detail::shared_ring_header;
+
+  static constexpr std::size_t slots_offset_ =
+      (sizeof(header_type) + detail::slot_alignment<T> - 1) /
+      detail::slot_alignment<T> * detail::slot_alignment<T>;
+
+  std::string name_;  ///< Shared memory object name
+  bool owner_;        ///< Whether this object created (and will unlink) it
+  std::size_t mapping_size_;
+  header_type* header_;
+  T* slots_;
+  std::size_t capacity_;
+  std::size_t index_mask_;
+
+  // Process-local caches of the other side's index
+  alignas(detail::cache_line_size) std::uint64_t head_cache_{0};
+  alignas(detail::cache_line_size) std::uint64_t tail_cache_{0};
+
+  [[noreturn]] static void throw_errno(const char* what) {
+    throw std::system_error(errno, std::generic_category(), what);
+  }
+
+  static void* map(int fd, std::size_t size) {
+    void* p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) {
+      const int error = errno;
+      ::close(fd);
+      throw std::system_error(error, std::generic_category(), "mmap");
+    }
+    ::close(fd);
+    return p;
+  }
+
+  [[nodiscard]] T* slot(std::uint64_t index) const noexcept {
+    return slots_ + (index & index_mask_);
+  }
+
+ public:
+  using value_type = T;
+  using size_type = std::size_t;
+
+  /**
+   * @brief Creates a new shared region and formats the ring inside it
+   * @param name POSIX shared memory name (e.g. "/feed"); must not exist yet
+   * @param capacity Desired capacity (will be rounded up to power of 2, min 1)
+   * @throws std::system_error If the region cannot be created or mapped
+   * @note The name is unlinked when this object is destroyed; processes that
+   *       already attached keep their mapping
+   */
+  SharedSPSCRingBuffer(create_shared_t, std::string name, size_type capacity)
+      : name_(std::move(name)),
+        owner_(true),
+        capacity_(detail::next_power_of_2(capacity)),
+        index_mask_(capacity_ - 1) {
+    mapping_size_ = slots_offset_ + capacity_ * sizeof(T);
+
+    const int fd = ::shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+      throw_errno("shm_open");
+    }
+    if (::ftruncate(fd, static_cast<off_t>(mapping_size_)) != 0) {
+      const int error = errno;
+      ::close(fd);
+      ::shm_unlink(name_.c_str());
+      throw std::system_error(error, std::generic_category(), "ftruncate");
+    }
+    void* base = nullptr;
+    try {
+      base = map(fd, mapping_size_);
+    } catch (...) {
+      ::shm_unlink(name_.c_str());
+      throw;
+    }
+
+    header_ = std::construct_at(static_cast<header_type*>(base));
+    header_->version = header_type::current_version;
+    header_->header_size = sizeof(header_type);
+    header_->element_size = sizeof(T);
+    header_->element_alignment = alignof(T);
+    header_->capacity = capacity_;
+    header_->slots_offset = slots_offset_;
+    header_->head.store(0, std::memory_order_relaxed);
+    header_->tail.store(0, std::memory_order_relaxed);
+    header_->magic.store(header_type::expected_magic,
+                         std::memory_order_release);
+
+    slots_ = reinterpret_cast<T*>(static_cast<std::byte*>(base) +
+                                  slots_offset_);
+  }
+
+  /**
+   * @brief Attaches to a region created by another process
+   * @param name POSIX shared memory name passed to the creator
+   * @throws std::system_error If the region cannot be opened or mapped
+   * @throws std::runtime_error If the region is not initialized yet, was
+   *         created with a different layout version or element type, or its
+   *         header describes a ring that does not fit the region
+   */
+  SharedSPSCRingBuffer(attach_shared_t, std::string name)
+      : name_(std::move(name)), owner_(false) {
+    const int fd = ::shm_open(name_.c_str(), O_RDWR, 0600);
+    if (fd < 0) {
+      throw_errno("shm_open");
+    }
+    struct stat st {};
+    if (::fstat(fd, &st) != 0) {
+      const int error = errno;
+      ::close(fd);
+      throw std::system_error(error, std::generic_category(), "fstat");
+    }
+    mapping_size_ = static_cast<std::size_t>(st.st_size);
+    if (mapping_size_ < sizeof(header_type)) {
+      ::close(fd);
+      throw std::runtime_error("shared ring is not initialized");
+    }
+
+    void* base = map(fd, mapping_size_);
+    header_ = static_cast<header_type*>(base);
+
+    const char* error = nullptr;
+    if (header_->magic.load(std::memory_order_acquire) !=
+        header_type::expected_magic) {
+      error = "shared ring is not initialized";
+    } else if (header_->version != header_type::current_version ||
+               header_->header_size != sizeof(header_type)) {
+      error = "shared ring layout version mismatch";
+    } else if (header_->element_size != sizeof(T) ||
+               header_->element_alignment != alignof(T)) {
+      error = "shared ring element type mismatch";
+    } else if (!std::has_single_bit(header_->capacity) ||
+               header_->slots_offset < sizeof(header_type) ||
+               header_->slots_offset % alignof(T) != 0) {
+      // Slot access masks with capacity - 1 and offsets from the header
+      error = "shared ring header is corrupt";
+    } else if (header_->slots_offset > mapping_size_ ||
+               header_->capacity >
+                   (mapping_size_ - header_->slots_offset) / sizeof(T)) {
+      // Divide rather than multiply, so a huge capacity cannot wrap around
+      error = "shared ring is truncated";
+    }
+    if (error) {
+      ::munmap(base, mapping_size_);
+      throw std::runtime_error(error);
+    }
+
+    capacity_ = header_->capacity;
+    index_mask_ = capacity_ - 1;
+    slots_ = reinterpret_cast<T*>(static_cast<std::byte*>(base) +
+                                  header_->slots_offset);
+    head_cache_ = header_->head.load(std::memory_order_acquire);
+    tail_cache_ = header_->tail.load(std::memory_order_acquire);
+  }
+
+  /**
+   * @brief Destructor
+   * @note Unmaps the region, and unlinks its name if this object created it
+   */
+  ~SharedSPSCRingBuffer() {
+    ::munmap(header_, mapping_size_);
+    if (owner_) {
+      ::shm_unlink(name_.c_str());
+    }
+  }
+
+  // Non-copyable and non-movable for safety
+  SharedSPSCRingBuffer(const SharedSPSCRingBuffer&) = delete;
+  SharedSPSCRingBuffer& operator=(const SharedSPSCRingBuffer&) = delete;
+  SharedSPSCRingBuffer(SharedSPSCRingBuffer&&) = delete;
+  SharedSPSCRingBuffer& operator=(SharedSPSCRingBuffer&&) = delete;
+
+  /**
+   * @brief Attempt to push an element
+   * @param item The element to copy into the buffer
+   * @return true if the element was successfully added, false if buffer full
+   * @note This function should only be called from the producer
+   */
+  [[nodiscard]] bool try_push(const T& item) noexcept {
+    T* dst = try_reserve();
+    if (!dst) {
+      return false;
+    }
+    std::memcpy(static_cast<void*>(dst), &item, sizeof(T));
+    commit();
+    return true;
+  }
+
+  /**
+   * @brief Attempt to push a contiguous batch of elements with one publish
+   * @param items The elements to copy into the buffer
+   * @return The number of elements pushed, which is less than items.size()
+   *         if the buffer fills up
+   * @note This function should only be called from the producer
+   */
+  [[nodiscard]] size_type try_push_n(std::span<const T> items) noexcept {
+    const auto current_tail = header_->tail.load(std::memory_order_relaxed);
+
+    auto available = capacity_ - (current_tail - head_cache_);
+    if (available < items.size()) {
+      head_cache_ = header_->head.load(std::memory_order_acquire);
+      available = capacity_ - (current_tail - head_cache_);
+    }
+
+    const auto count = std::min<size_type>(items.size(), available);
+    const auto offset = current_tail & index_mask_;
+    const auto first_segment = std::min(count, capacity_ - offset);
+    std::memcpy(static_cast<void*>(slots_ + offset), items.data(),
+                first_segment * sizeof(T));
+    std::memcpy(static_cast<void*>(slots_), items.data() + first_segment,
+                (count - first_segment) * sizeof(T));
+
+    header_->tail.store(current_tail + count, std::memory_order_release);
+    return count;
+  }
+
+  /**
+   * @brief Reserve the next slot for in-place writing
+   * @return Pointer to the slot at the tail, or nullptr if buffer full
+   * @note This function should only be called from the producer
+   * @note The slot is not visible to the consumer until commit() is called
+   */
+  [[nodiscard]] T* try_reserve() noexcept {
+    const auto current_tail = header_->tail.load(std::memory_order_relaxed);
+
+    if (current_tail - head_cache_ == capacity_) {
+      head_cache_ = header_->head.load(std::memory_order_acquire);
+      if (current_tail - head_cache_ == capacity_) {
+        return nullptr;
+      }
+    }
+
+    return slot(current_tail);
+  }
+
+  /**
+   * @brief Publish the slot obtained from try_reserve()
+   * @note This function should only be called from the producer
+   */
+  void commit() noexcept {
+    const auto current_tail = header_->tail.load(std::memory_order_relaxed);
+    header_->tail.store(current_tail + 1, std::memory_order_release);
+  }
+
+  /**
+   * @brief Get pointer to front element without removing it
+   * @return Pointer to front element, or nullptr if buffer is empty
+   * @note This function should only be called from the consumer
+   * @note You must call pop() after processing the element
+   */
+  [[nodiscard]] T* front() noexcept {
+    const auto current_head = header_->head.load(std::memory_order_relaxed);
+
+    if (current_head == tail_cache_) {
+      tail_cache_ = header_->tail.load(std::memory_order_acquire);
+      if (current_head == tail_cache_) {
+        return nullptr;
+      }
+    }
+
+    return slot(current_head);
+  }
+
+  /**
+   * @brief Remove the front element
+   * @note This function should only be called from the consumer
+   * @warning Calling pop() on an empty buffer is undefined behavior
+   */
+  void pop() noexcept {
+    const auto current_head = header_->head.load(std::memory_order_relaxed);
+    assert(current_head != header_->tail.load(std::memory_order_relaxed) &&
+           "pop() called on empty buffer");
+    header_->head.store(current_head + 1, std::memory_order_release);
+  }
+
+  /**
+   * @brief Attempt to pop an element
+   * @return std::optional containing the popped element if successful,
+   *         std::nullopt if buffer is empty
+   * @note This function should only be called from the consumer
+   */
+  [[nodiscard]] std::optional<T> try_pop() noexcept {
+    const T* item = front();
+    if (!item) {
+      return std::nullopt;
+    }
+    std::optional<T> result(*item);
+    pop();
+    return result;
+  }
+
+  /**
+   * @brief Check if the buffer appears empty
+   * @return true if the buffer appears empty at the time of the call
+   * @note This is an approximate check due to concurrent access.
+   */
+  [[nodiscard]] bool empty() const noexcept {
+    return header_->head.load(std::memory_order_relaxed) ==
+           header_->tail.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Get the approximate current size
+   * @return The approximate number of elements currently in the buffer
+   * @note This is an approximate value due to concurrent access.
+   */
+  [[nodiscard]] size_type size() const noexcept {
+    const auto head = header_->head.load(std::memory_order_acquire);
+    const auto tail = header_->tail.load(std::memory_order_relaxed);
+    return std::min<size_type>(tail - head, capacity_);
+  }
+
+  /**
+   * @brief Get the maximum capacity
+   * @return The maximum number of elements this buffer can hold
+   */
+  [[nodiscard]] size_type capacity() const noexcept { return capacity_; }
+
+  /**
+   * @brief Get the shared memory object name
+   * @return The name passed at construction
+   */
+  [[nodiscard]] const std::string& name() const noexcept { return name_; }
+};
+
+}  // namespace fadli
@@ -0,0 +1,354 @@
+/**
+ * @file UnboundedSPSCQueue.hpp
+ * @brief A lock-free unbounded spsc queue of chained ring blocks.
+ * @author Fadli Arsani <fadlialim0029@gmail.com>
+ * @version 1.0.0
+ *
+ * MIT License
+ *
+ * Copyright (c) 2025 Fadli Arsani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "SPSCRingBuffer.hpp"
+
+namespace fadli {
+
+/**
+ * @brief Lock-free single-producer single-consumer queue that grows on
+ *        demand
+ * @tparam T The type of elements stored in the queue
+ * @tparam Allocator Allocator for the slots of each block
+ *
+ * Elements live in fixed-size SPSCRingBuffer blocks linked into a circle.
+ * The producer fills the block it is on; when that is full it moves to the
+ * next block in the circle if the consumer has already drained and left
+ * it, and otherwise splices a newly allocated block in. The consumer moves
+ * on once its block is empty and the producer has moved past it.
+ *
+ * Drained blocks thus stay in the circle as the free list, so after the
+ * largest burst has been absorbed the queue allocates nothing. Blocks are
+ * only freed by the destructor.
+ * @warning This class is NOT thread-safe for multiple producers or consumers.
+ * @code
+ * fadli::UnboundedSPSCQueue<Order> q(256);
+ *
+ * // Producer thread
+ * q.push(order);  // never fails, may allocate a block
+ *
+ * // Consumer thread
+ * while (auto* o = q.front()) {
+ *     handle(*o);
+ *     q.pop();
+ * }
+ * @endcode
+ */
+template <typename T, typename Allocator = AlignedAllocator<T>>
+class UnboundedSPSCQueue {
+ public:
+  using ring_type = SPSCRingBuffer<T, dynamic_capacity, Allocator>;
+  using value_type = T;
+  using size_type = std::size_t;
+  using allocator_type = Allocator;
+
+  /**
+   * @brief Constructs a queue with a single block
+   * @param block_capacity Capacity of every block (rounded up to power of 2)
+   * @param initial_blocks Number of blocks allocated up front, at least 1
+   * @param alloc Allocator for the slots of each block
+   * @throws std::bad_alloc If memory allocation fails
+   */
+  explicit UnboundedSPSCQueue(size_type block_capacity = 512,
+                              size_type initial_blocks = 1,
+                              const Allocator& alloc = Allocator())
+      : block_capacity_(detail::next_power_of_2(block_capacity)),
+        alloc_(alloc) {
+    block* first = make_block();
+    first->next.store(first, std::memory_order_relaxed);
+    producer_.tail_block = first;
+    producer_.blocks = 1;
+    try {
+      for (; producer_.blocks < initial_blocks; ++producer_.blocks) {
+        splice_after(first, make_block());
+      }
+    } catch (...) {
+      free_blocks();
+      throw;
+    }
+    tail_block_.store(first, std::memory_order_relaxed);
+    consumer_.front_block = first;
+    front_block_.store(first, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Destructor
+   * @note Destroys any elements still in the queue and frees every block
+   */
+  ~UnboundedSPSCQueue() { free_blocks(); }
+
+  // Non-copyable and non-movable for safety
+  UnboundedSPSCQueue(const UnboundedSPSCQueue&) = delete;
+  UnboundedSPSCQueue& operator=(const UnboundedSPSCQueue&) = delete;
+  UnboundedSPSCQueue(UnboundedSPSCQueue&&) = delete;
+  UnboundedSPSCQueue& operator=(UnboundedSPSCQueue&&) = delete;
+
+  /**
+   * @brief Attempt to construct an element in place without allocating
+   * @param args Arguments forwarded to the constructor of T
+   * @return true if the element was added, false if every block is in use
+   * @note This function should only be called from the producer thread
+   */
+  template <typename... Args>
+  [[nodiscard]] bool try_emplace(Args&&... args) noexcept(
+      std::is_nothrow_constructible_v<T, Args&&...>) {
+    if (producer_.tail_block->ring.try_emplace(std::forward<Args>(args)...)) {
+      return true;
+    }
+    block* next = producer_.tail_block->next.load(std::memory_order_relaxed);
+    if (next == front_block_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    advance_tail(next);
+    return next->ring.try_emplace(std::forward<Args>(args)...);
+  }
+
+  /**
+   * @brief Construct an element in place, allocating a block if needed
+   * @param args Arguments forwarded to the constructor of T
+   * @note This function should only be called from the producer thread
+   * @throws std::bad_alloc If a new block is needed and cannot be allocated
+   */
+  template <typename... Args>
+  void emplace(Args&&... args) {
+    if (producer_.tail_block->ring.try_emplace(std::forward<Args>(args)...)) {
+      return;
+    }
+    block* next = producer_.tail_block->next.load(std::memory_order_relaxed);
+    if (next == front_block_.load(std::memory_order_acquire)) {
+      // Every other block still holds data: grow the circle here
+      next = make_block();
+      splice_after(producer_.tail_block, next);
+      ++producer_.blocks;
+    }
+    advance_tail(next);
+    const bool pushed = next->ring.try_emplace(std::forward<Args>(args)...);
+    assert(pushed && "fresh block is full");
+    (void)pushed;
+  }
+
+  /**
+   * @brief Attempt to push an element without allocating (copy version)
+   * @param item The element to add to the queue
+   * @return true if the element was added, false if every block is in use
+   * @note This function should only be called from the producer thread
+   */
+  [[nodiscard]] bool try_push(const T& item) noexcept(
+      std::is_nothrow_copy_constructible_v<T>) {
+    return try_emplace(item);
+  }
+
+  /**
+   * @brief Attempt to push an element without allocating (move version)
+   * @param item The element to move into the queue
+   * @return true if the element was added, false if every block is in use
+   * @note This function should only be called from the producer thread
+   */
+  [[nodiscard]] bool try_push(T&& item) noexcept(
+      std::is_nothrow_move_constructible_v<T>) {
+    return try_emplace(std::move(item));
+  }
+
+  /**
+   * @brief Push an element, allocating a block if needed (copy version)
+   * @param item The element to add to the queue
+   * @note This function should only be called from the producer thread
+   * @throws std::bad_alloc If a new block is needed and cannot be allocated
+   */
+  void push(const T& item) { emplace(item); }
+
+  /**
+   * @brief Push an element, allocating a block if needed (move version)
+   * @param item The element to move into the queue
+   * @note This function should only be called from the producer thread
+   * @throws std::bad_alloc If a new block is needed and cannot be allocated
+   */
+  void push(T&& item) { emplace(std::move(item)); }
+
+  /**
+   * @brief Get pointer to front element without removing it
+   * @return Pointer to front element, or nullptr if queue is empty
+   * @note This function should only be called from the consumer thread
+   * @note You must call pop() after processing the element
+   */
+  [[nodiscard]] T* front() noexcept {
+    block* b = consumer_.front_block;
+    if (T* item = b->ring.front()) {
+      return item;
+    }
+    if (b == tail_block_.load(std::memory_order_acquire)) {
+      return nullptr;
+    }
+    // The producer has moved on, so whatever it left here is visible now
+    if (T* item = b->ring.front()) {
+      return item;
+    }
+    b = b->next.load(std::memory_order_acquire);
+    consumer_.front_block = b;
+    front_block_.store(b, std::memory_order_release);
+    return b->ring.front();
+  }
+
+  /**
+   * @brief Remove the front element
+   * @note This function should only be called from the consumer thread
+   * @warning Calling pop() without a successful front() is undefined behavior
+   */
+  void pop() noexcept { consumer_.front_block->ring.pop(); }
+
+  /**
+   * @brief Attempt to pop an element
+   * @return std::optional containing the popped element if successful,
+   *         std::nullopt if queue is empty
+   * @note This function should only be called from the consumer thread
+   */
+  [[nodiscard]] std::optional<T> try_pop() noexcept(
+      std::is_nothrow_move_constructible_v<T>) {
+    T* item = front();
+    if (item == nullptr) {
+      return std::nullopt;
+    }
+    std::optional<T> result(std::move(*item));
+    pop();
+    return result;
+  }
+
+  /**
+   * @brief Check if the queue appears empty
+   * @return true if the queue appears empty at the time of the call
+   * @note This is an approximate check due to concurrent access. Call it from
+   *       the consumer thread for an exact answer about its own view.
+   */
+  [[nodiscard]] bool empty() const noexcept {
+    const block* b = front_block_.load(std::memory_order_acquire);
+    return b == tail_block_.load(std::memory_order_acquire) && b->ring.empty();
+  }
+
+  /**
+   * @brief Get the number of blocks allocated so far
+   * @return Blocks in the circle, which never shrinks
+   * @note This function should only be called from the producer thread
+   */
+  [[nodiscard]] size_type block_count() const noexcept {
+    return producer_.blocks;
+  }
+
+  /**
+   * @brief Get the capacity of one block
+   * @return The number of elements each block holds
+   */
+  [[nodiscard]] size_type block_capacity() const noexcept {
+    return block_capacity_;
+  }
+
+  /**
+   * @brief Get a copy of the allocator
+   * @return The allocator used for the slots of each block
+   */
+  [[nodiscard]] allocator_type get_allocator() const noexcept {
+    return alloc_;
+  }
+
+ private:
+  struct block {
+    block(size_type capacity, const Allocator& alloc) : ring(capacity, alloc) {}
+
+    ring_type ring;
+    std::atomic<block*> next{nullptr};
+  };
+
+  using block_allocator =
+      typename std::allocator_traits<Allocator>::template rebind_alloc<block>;
+  using block_traits = std::allocator_traits<block_allocator>;
+
+  [[nodiscard]] block* make_block() {
+    block* b = std::to_address(block_traits::allocate(block_alloc_, 1));
+    try {
+      block_traits::construct(block_alloc_, b, block_capacity_, alloc_);
+    } catch (...) {
+      block_traits::deallocate(block_alloc_, b, 1);
+      throw;
+    }
+    return b;
+  }
+
+  void free_blocks() noexcept {
+    block* first = producer_.tail_block;
+    block* b = first;
+    do {
+      block* next = b->next.load(std::memory_order_relaxed);
+      block_traits::destroy(block_alloc_, b);
+      block_traits::deallocate(block_alloc_, b, 1);
+      b = next;
+    } while (b != first);
+  }
+
+  // Producer only; the release store publishes the constructed block
+  static void splice_after(block* at, block* b) noexcept {
+    b->next.store(at->next.load(std::memory_order_relaxed),
+                  std::memory_order_relaxed);
+    at->next.store(b, std::memory_order_release);
+  }
+
+  void advance_tail(block* next) noexcept {
+    producer_.tail_block = next;
+    tail_block_.store(next, std::memory_order_release);
+  }
+
+  size_type block_capacity_;  ///< Capacity of every block (power of 2)
+  [[no_unique_address]] Allocator alloc_;
+  [[no_unique_address]] block_allocator block_alloc_{alloc_};
+
+  // Each side keeps a private copy of the block it is on next to the shared
+  // pointer it publishes, on separate lines
+  struct alignas(detail::cache_line_size) producer_state {
+    block* tail_block{nullptr};
+    size_type blocks{0};  ///< Blocks in the circle
+  };
+  struct alignas(detail::cache_line_size) consumer_state {
+    block* front_block{nullptr};
+  };
+
+  producer_state producer_;
+  alignas(detail::cache_line_size) std::atomic<block*> tail_block_{nullptr};
+  consumer_state consumer_;
+  alignas(detail::cache_line_size) std::atomic<block*> front_block_{nullptr};
+};
+
+}  // namespace fadli
@@ -0,0 +1,64 @@
+/**
+ * @file check.hpp
+ * @brief Minimal assertion and driver helpers shared by the tests.
+ *
+ * The tests are plain executables so they build without a test framework:
+ * a failed CHECK prints the expression and aborts, which ctest reports as a
+ * failure, and sanitizers get a stack trace at the point of failure.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+#define CHECK(cond)                                                    \
+  do {                                                                 \
+    if (!(cond)) {                                                     \
+      std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__,      \
+                   __LINE__, #cond);                                   \
+      std::abort();                                                    \
+    }                                                                  \
+  } while (0)
+
+#define CHECK_EQ(a, b)                                                 \
+  do {                                                                 \
+    const auto check_a_ = (a);                                         \
+    const auto check_b_ = (b);                                         \
+    if (!(check_a_ == check_b_)) {                                     \
+      std::fprintf(stderr, "%s:%d: CHECK_EQ failed: %s == %s\n",       \
+                   __FILE__, __LINE__, #a, #b);                        \
+      std::abort();                                                    \
+    }                                                                  \
+  } while (0)
+
+namespace fadli::test {
+
+// Elements per stress configuration: argv[1], else FADLI_STRESS_OPS, else
+// the given default. Multi-billion soak runs are opt-in this way.
+inline std::size_t stress_ops(int argc, char** argv, std::size_t fallback) {
+  if (argc > 1) {
+    return std::stoull(argv[1]);
+  }
+  if (const char* env = std::getenv("FADLI_STRESS_OPS")) {
+    return std::stoull(env);
+  }
+  return fallback;
+}
+
+// Run one named case and report it, so a hang or abort is easy to place
+template <typename F>
+void run(const char* name, F&& f) {
+  std::fprintf(stderr, "%-48s", name);
+  f();
+  std::fprintf(stderr, " ok\n");
+}
+
+// Back-off used by the busy loops; yielding keeps the tests fair on
+// machines with fewer cores than threads
+inline void idle() noexcept { std::this_thread::yield(); }
+
+}  // namespace fadli::test
@@ -0,0 +1,176 @@
+/*
+ * C11 model of the SPSCRingBuffer index protocol for the GenMC model checker.
+ *
+ *   genmc -rc11 -- spsc_protocol.c
+ *   genmc -imm -- -DLAZY_PUBLISH spsc_protocol.c
+ *
+ * GenMC explores every execution the memory model allows, so unlike the
+ * stress tests this proves the orderings rather than sampling them: a
+ * consumer reading a slot before its element is published, or a producer
+ * overwriting one before it is consumed, is a data race on the non-atomic
+ * slots and is reported as an error, as is a failed assertion.
+ *
+ * Mirrors SPSCRingBuffer::try_emplace(), front()/pop(), the cached indices,
+ * lazy publication (publish_interval, flush() on full, flush_consumer() on
+ * empty) and the park/notify handshake of the blocking calls. Keep it in step
+ * with include/fadli/SPSCRingBuffer.hpp when the protocol changes.
+ */
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
+
+#include <genmc.h>
+
+#define CAPACITY 2
+#define ITEMS 3
+/* Attempts per element before the execution is pruned; two lets one attempt
+ * see the ring full or empty and the retry succeed */
+#define ATTEMPTS 2
+
+#ifdef LAZY_PUBLISH
+#define PUBLISH_INTERVAL 2
+#else
+#define PUBLISH_INTERVAL 1
+#endif
+
+static int slots[CAPACITY];
+static atomic_size_t head;
+static atomic_size_t tail;
+static atomic_int consumer_waiting;
+
+/* Producer-private */
+static size_t producer_tail;
+static size_t published_tail;
+static size_t head_cache;
+
+/* Consumer-private */
+static size_t consumer_head;
+static size_t published_head;
+static size_t tail_cache;
+
+static void flush(void) {
+  if (producer_tail != published_tail) {
+    published_tail = producer_tail;
+    atomic_store_explicit(&tail, producer_tail, memory_order_release);
+  }
+}
+
+static void flush_consumer(void) {
+  if (consumer_head != published_head) {
+    published_head = consumer_head;
+    atomic_store_explicit(&head, consumer_head, memory_order_release);
+  }
+}
+
+static int try_push(int value) {
+  const size_t current_tail = producer_tail;
+  if (current_tail - head_cache == CAPACITY) {
+    head_cache = atomic_load_explicit(&head, memory_order_acquire);
+    if (current_tail - head_cache == CAPACITY) {
+      flush();
+      return 0;
+    }
+  }
+  slots[current_tail % CAPACITY] = value;
+  producer_tail = current_tail + 1;
+  if (producer_tail - published_tail >= PUBLISH_INTERVAL) {
+    published_tail = producer_tail;
+    atomic_store_explicit(&tail, producer_tail, memory_order_release);
+  }
+  return 1;
+}
+
+static int try_pop(int* value) {
+  const size_t current_head = consumer_head;
+  if (current_head == tail_cache) {
+    tail_cache = atomic_load_explicit(&tail, memory_order_acquire);
+    if (current_head == tail_cache) {
+      flush_consumer();
+      return 0;
+    }
+  }
+  *value = slots[current_head % CAPACITY];
+  consumer_head = current_head + 1;
+  if (consumer_head - published_head >= PUBLISH_INTERVAL) {
+    published_head = consumer_head;
+    atomic_store_explicit(&head, consumer_head, memory_order_release);
+  }
+  return 1;
+}
+
+static void* producer(void* arg) {
+  (void)arg;
+  for (int i = 1; i <= ITEMS; ++i) {
+    int pushed = 0;
+    for (int attempt = 0; attempt < ATTEMPTS && !pushed; ++attempt) {
+      pushed = try_push(i);
+    }
+    __VERIFIER_assume(pushed);
+  }
+  flush();
+  return NULL;
+}
+
+static void* consumer(void* arg) {
+  (void)arg;
+  for (int i = 1; i <= ITEMS; ++i) {
+    int value = 0;
+    int popped = 0;
+    for (int attempt = 0; attempt < ATTEMPTS && !popped; ++attempt) {
+      popped = try_pop(&value);
+    }
+    __VERIFIER_assume(popped);
+    assert(value == i);
+  }
+  flush_consumer();
+  return NULL;
+}
+
+/*
+ * Park/notify: the consumer raises its flag and re-reads tail before it
+ * sleeps; the producer publishes tail with a plain release store, then issues
+ * a seq_cst fence and reads the flag relaxed. By default only the blocking
+ * calls do the second half, in notify_consumer(); with Traits::blocking every
+ * publish does, in wake_consumer(). Either way a wakeup is lost only if the
+ * consumer sleeps on the old tail and the producer misses the flag, which
+ * must be impossible.
+ */
+static size_t parked_on;
+static int saw_waiter;
+
+static void* parking_consumer(void* arg) {
+  (void)arg;
+  atomic_store_explicit(&consumer_waiting, 1, memory_order_seq_cst);
+  parked_on = atomic_load_explicit(&tail, memory_order_seq_cst);
+  return NULL;
+}
+
+static void* notifying_producer(void* arg) {
+  (void)arg;
+  atomic_store_explicit(&tail, 1, memory_order_release);
+  atomic_thread_fence(memory_order_seq_cst);
+  saw_waiter =
+      atomic_load_explicit(&consumer_waiting, memory_order_relaxed);
+  return NULL;
+}
+
+int main(void) {
+  pthread_t p;
+  pthread_t c;
+
+  pthread_create(&p, NULL, producer, NULL);
+  pthread_create(&c, NULL, consumer, NULL);
+  pthread_join(p, NULL);
+  pthread_join(c, NULL);
+  assert(atomic_load(&head) == ITEMS && atomic_load(&tail) == ITEMS);
+
+  atomic_store(&tail, 0);
+  pthread_create(&p, NULL, notifying_producer, NULL);
+  pthread_create(&c, NULL, parking_consumer, NULL);
+  pthread_join(p, NULL);
+  pthread_join(c, NULL);
+  assert(!(parked_on == 0 && !saw_waiter));
+  return 0;
+}
@@ -0,0 +1,813 @@
+/**
+ * @file queues_stress.cpp
+ * @brief Threaded validation of the queues built around SPSCRingBuffer.
+ *
+ * Usage: queues_stress [ops]
+ *
+ * Each queue is driven by real threads and checked against the guarantee it
+ * documents: exactly-once and per-producer order for the MPMC family and
+ * SPSCFanIn, the full sequence for every reader of a gated broadcast,
+ * monotonic untorn values for the overwriting rings, newest-value-per-key for
+ * ConflatingQueue, FIFO for the unbounded, coroutine, eventfd, byte and
+ * pipeline variants, and for the journal also a concurrent replay and a
+ * resume from the files. Heterogeneous messages must arrive with their type
+ * and be destroyed exactly once. Build with -DFADLI_SANITIZE=thread for TSan
+ * coverage.
+ *
+ * ops (or FADLI_STRESS_OPS) is the number of elements per producer.
+ */
+
+#include <poll.h>
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fadli/AsyncSPSCRingBuffer.hpp>
+#include <fadli/BroadcastRingBuffer.hpp>
+#include <fadli/ByteRingBuffer.hpp>
+#include <fadli/ConflatingQueue.hpp>
+#include <fadli/EventFdSPSCRingBuffer.hpp>
+#include <fadli/JournalRingBuffer.hpp>
+#include <fadli/LossyRingBuffer.hpp>
+#include <fadli/MPMCRingBuffer.hpp>
+#include <fadli/MessageRingBuffer.hpp>
+#include <fadli/Pipeline.hpp>
+#include <fadli/SPSCFanIn.hpp>
+#include <fadli/UnboundedSPSCQueue.hpp>
+
+#include "check.hpp"
+
+namespace {
+
+using fadli::test::idle;
+
+constexpr unsigned producer_shift = 40;
+
+std::uint64_t tag(std::size_t producer, std::uint64_t i) noexcept {
+  return (std::uint64_t{producer} << producer_shift) | i;
+}
+
+// What the consumers saw from one producer, merged across consumers
+struct Tally {
+  std::uint64_t count = 0;
+  std::uint64_t sum = 0;
+  std::uint64_t sum_squares = 0;
+};
+
+// Runs producers pushing tagged sequences and consumers popping them. Each
+// consumer must see every producer's values in increasing order (in exact
+// sequence with a single consumer), and across consumers every value must
+// arrive exactly once, checked through count, sum and sum of squares.
+template <typename Push, typename Pop>
+void run_multi(std::size_t producers, std::size_t consumers,
+               std::uint64_t ops, Push push, Pop pop) {
+  const auto total = producers * ops;
+  std::atomic<std::uint64_t> consumed{0};
+  std::mutex merge_mutex;
+  std::vector<Tally> tallies(producers);
+
+  std::vector<std::thread> threads;
+  for (std::size_t p = 0; p < producers; ++p) {
+    threads.emplace_back([&, p] {
+      for (std::uint64_t i = 0; i < ops;) {
+        if (push(p, tag(p, i))) {
+          ++i;
+        } else {
+          idle();
+        }
+      }
+    });
+  }
+  for (std::size_t c = 0; c < consumers; ++c) {
+    threads.emplace_back([&] {
+      std::vector<Tally> local(producers);
+      std::vector<std::uint64_t> next(producers, 0);
+      while (consumed.load(std::memory_order_relaxed) < total) {
+        const std::optional<std::uint64_t> value = pop();
+        if (!value) {
+          idle();
+          continue;
+        }
+        const auto p = *value >> producer_shift;
+        const auto i = *value & ((std::uint64_t{1} << producer_shift) - 1);
+        CHECK(p < producers);
+        CHECK(i >= next[p]);
+        if (consumers == 1) {
+          CHECK_EQ(i, next[p]);
+        }
+        next[p] = i + 1;
+        local[p].count += 1;
+        local[p].sum += i;
+        local[p].sum_squares += i * i;
+        consumed.fetch_add(1, std::memory_order_relaxed);
+      }
+      std::lock_guard lock(merge_mutex);
+      for (std::size_t p = 0; p < producers; ++p) {
+        tallies[p].count += local[p].count;
+        tallies[p].sum += local[p].sum;
+        tallies[p].sum_squares += local[p].sum_squares;
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  Tally expected;
+  for (std::uint64_t i = 0; i < ops; ++i) {
+    expected.count += 1;
+    expected.sum += i;
+    expected.sum_squares += i * i;
+  }
+  for (const auto& t : tallies) {
+    CHECK_EQ(t.count, expected.count);
+    CHECK_EQ(t.sum, expected.sum);
+    CHECK_EQ(t.sum_squares, expected.sum_squares);
+  }
+}
+
+template <typename Queue>
+void sequenced(std::size_t producers, std::size_t consumers,
+               std::uint64_t ops) {
+  for (std::size_t cap : {1, 2, 64}) {
+    Queue q(cap);
+    run_multi(
+        producers, consumers, ops,
+        [&](std::size_t, std::uint64_t v) { return q.try_push(v); },
+        [&] { return q.try_pop(); });
+    CHECK(q.empty());
+  }
+}
+
+void fan_in(std::uint64_t ops) {
+  for (auto order : {fadli::FanInOrder::round_robin,
+                     fadli::FanInOrder::priority}) {
+    fadli::SPSCFanIn<std::uint64_t> in(3, 8, order);
+    run_multi(
+        3, 1, ops,
+        [&](std::size_t p, std::uint64_t v) { return in.try_push(p, v); },
+        [&] { return in.try_pop(); });
+  }
+
+  // poll() hands out batches; feed them through a local buffer
+  fadli::SPSCFanIn<std::uint64_t> in(4, 16);
+  std::vector<std::uint64_t> batch;
+  std::size_t taken = 0;
+  run_multi(
+      4, 1, ops,
+      [&](std::size_t p, std::uint64_t v) { return in.try_push(p, v); },
+      [&]() -> std::optional<std::uint64_t> {
+        if (taken == batch.size()) {
+          batch.clear();
+          taken = 0;
+          in.poll([&](std::uint64_t& v) { batch.push_back(v); }, 5);
+          if (batch.empty()) {
+            return std::nullopt;
+          }
+        }
+        return batch[taken++];
+      });
+
+  bool rejected = false;
+  try {
+    fadli::SPSCFanIn<std::uint64_t> none(0, 16);
+  } catch (const std::invalid_argument&) {
+    rejected = true;
+  }
+  CHECK(rejected);
+}
+
+void broadcast_gated(std::uint64_t ops) {
+  constexpr std::size_t readers = 3;
+  for (std::size_t cap : {1, 4, 256}) {
+    fadli::BroadcastRingBuffer<std::uint64_t> q(cap, readers);
+    std::vector<std::thread> threads;
+    for (std::size_t r = 0; r < readers; ++r) {
+      threads.emplace_back([&, r] {
+        for (std::uint64_t expected = 0; expected < ops;) {
+          // Alternate the two read APIs
+          if (expected % 2 == 0) {
+            if (const auto* v = q.front(r)) {
+              CHECK_EQ(*v, expected++);
+              q.pop(r);
+              continue;
+            }
+          } else if (const auto v = q.try_pop(r)) {
+            CHECK_EQ(*v, expected++);
+            continue;
+          }
+          idle();
+        }
+        CHECK(q.empty(r));
+      });
+    }
+    for (std::uint64_t i = 0; i < ops;) {
+      if (q.try_push(i)) {
+        ++i;
+      } else {
+        idle();
+      }
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+  }
+}
+
+// Every word derived from the sequence number, so a torn copy is caught
+struct Line {
+  std::uint64_t words[8];
+
+  static Line make(std::uint64_t i) noexcept {
+    Line line;
+    for (std::uint64_t w = 0; w < 8; ++w) {
+      line.words[w] = i * 8 + w;
+    }
+    return line;
+  }
+  std::uint64_t value() const noexcept {
+    for (std::uint64_t w = 1; w < 8; ++w) {
+      CHECK_EQ(words[w], words[0] + w);
+    }
+    return words[0] / 8;
+  }
+};
+
+// An overwriting reader may miss values but never sees one twice, out of
+// order or torn, and ends with the last value pushed
+template <typename Pop>
+std::uint64_t check_lossy_reader(std::atomic<bool>& done, Pop pop) {
+  std::uint64_t next = 0;
+  for (;;) {
+    const bool finished = done.load(std::memory_order_acquire);
+    if (const auto line = pop()) {
+      const auto v = line->value();
+      CHECK(v >= next);
+      next = v + 1;
+    } else if (finished) {
+      return next;
+    } else {
+      idle();
+    }
+  }
+}
+
+void lossy(std::uint64_t ops) {
+  for (std::size_t cap : {1, 4, 64}) {
+    fadli::LossyRingBuffer<Line> q(cap);
+    std::atomic<bool> done{false};
+    std::thread producer([&] {
+      for (std::uint64_t i = 0; i < ops; ++i) {
+        q.push(Line::make(i));
+        if (i % 64 == 0) {
+          idle();
+        }
+      }
+      done.store(true, std::memory_order_release);
+    });
+    // Alternate between taking values in order and skipping to the newest
+    std::uint64_t calls = 0;
+    const auto next = check_lossy_reader(done, [&] {
+      return ++calls % 3 == 0 ? q.try_pop_latest() : q.try_pop();
+    });
+    producer.join();
+    CHECK_EQ(next, ops);
+  }
+
+  constexpr std::size_t readers = 2;
+  fadli::BroadcastRingBuffer<Line, fadli::BroadcastMode::overwrite> q(8,
+                                                                      readers);
+  std::atomic<bool> done{false};
+  std::vector<std::thread> threads;
+  for (std::size_t r = 0; r < readers; ++r) {
+    threads.emplace_back([&, r] {
+      const auto next = check_lossy_reader(done, [&] { return q.try_pop(r); });
+      CHECK_EQ(next, ops);
+    });
+  }
+  for (std::uint64_t i = 0; i < ops; ++i) {
+    q.push(Line::make(i));
+  }
+  done.store(true, std::memory_order_release);
+  for (auto& t : threads) {
+    t.join();
+  }
+}
+
+// Values per key only move forward, and once the producer is done the
+// consumer ends up with the newest value of every key
+void conflating(std::uint64_t ops) {
+  constexpr std::uint64_t keys = 16;
+  fadli::ConflatingQueue<std::uint64_t, Line> q(keys);
+  std::atomic<bool> done{false};
+  std::thread producer([&] {
+    for (std::uint64_t i = 0; i < ops; ++i) {
+      CHECK(q.try_push(i % keys, Line::make(i)));
+    }
+    done.store(true, std::memory_order_release);
+  });
+
+  std::vector<std::uint64_t> latest(keys, 0);
+  std::vector<bool> seen(keys, false);
+  const auto take = [&](const std::uint64_t& key, const Line& line) {
+    const auto v = line.value();
+    CHECK_EQ(v % keys, key);
+    CHECK(!seen[key] || v > latest[key]);
+    latest[key] = v;
+    seen[key] = true;
+  };
+  for (;;) {
+    const bool finished = done.load(std::memory_order_acquire);
+    if (q.poll(take, 7) == 0) {
+      if (finished) {
+        break;
+      }
+      idle();
+    }
+  }
+  producer.join();
+  CHECK(q.empty());
+  for (std::uint64_t key = 0; key < keys && key < ops; ++key) {
+    CHECK_EQ(latest[key], (ops - 1 - key) / keys * keys + key);
+  }
+}
+
+void unbounded(std::uint64_t ops) {
+  fadli::UnboundedSPSCQueue<std::uint64_t> q(4);
+  std::thread producer([&] {
+    for (std::uint64_t i = 0; i < ops; ++i) {
+      // Bursts force new blocks; the bounded pushes reuse drained ones
+      if (i % 1024 < 512) {
+        q.push(i);
+      } else {
+        while (!q.try_push(i)) {
+          idle();
+        }
+      }
+    }
+  });
+  for (std::uint64_t expected = 0; expected < ops;) {
+    if (const auto* v = q.front()) {
+      CHECK_EQ(*v, expected++);
+      q.pop();
+    } else {
+      idle();
+    }
+  }
+  producer.join();
+  CHECK(q.empty());
+}
+
+// Fire-and-forget coroutine, destroyed when it runs to completion
+struct detached {
+  struct promise_type {
+    detached get_return_object() noexcept { return {}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() noexcept {}
+    void unhandled_exception() noexcept { std::terminate(); }
+  };
+};
+
+template <typename Queue>
+detached async_produce(Queue& q, std::uint64_t ops, std::atomic<bool>& done) {
+  for (std::uint64_t i = 0; i < ops; ++i) {
+    co_await q.co_push(i);
+  }
+  done.store(true, std::memory_order_release);
+}
+
+template <typename Queue>
+detached async_consume(Queue& q, std::uint64_t ops, std::atomic<bool>& done) {
+  for (std::uint64_t expected = 0; expected < ops; ++expected) {
+    CHECK_EQ(co_await q.co_pop(), expected);
+  }
+  done.store(true, std::memory_order_release);
+}
+
+// With the inline executor each coroutine is resumed on the other's thread,
+// so both end up hopping between the two threads
+void async(std::uint64_t ops) {
+  for (std::size_t cap : {1, 16}) {
+    fadli::AsyncSPSCRingBuffer<std::uint64_t> q(cap);
+    std::atomic<bool> produced{false};
+    std::atomic<bool> consumed{false};
+    std::thread producer([&] { async_produce(q, ops, produced); });
+    async_consume(q, ops, consumed);
+    producer.join();
+    while (!produced.load(std::memory_order_acquire) ||
+           !consumed.load(std::memory_order_acquire)) {
+      idle();
+    }
+    CHECK(q.empty());
+  }
+}
+
+// The consumer only wakes from poll(2), so a lost signal shows up as a stall
+// until the timeout, caught by the elapsed-polls bound
+void eventfd(std::uint64_t ops) {
+  fadli::EventFdSPSCRingBuffer<std::uint64_t> q(8);
+  std::thread producer([&] {
+    for (std::uint64_t i = 0; i < ops;) {
+      if (q.try_push(i)) {
+        ++i;
+      } else {
+        idle();
+      }
+    }
+  });
+  std::uint64_t expected = 0;
+  std::uint64_t timeouts = 0;
+  pollfd pfd{q.fd(), POLLIN, 0};
+  while (expected < ops) {
+    const int ready = ::poll(&pfd, 1, 1000);
+    CHECK(ready >= 0);
+    if (ready == 0) {
+      ++timeouts;
+      CHECK(timeouts < 5);
+    }
+    do {
+      q.drain([&](std::uint64_t& v) { CHECK_EQ(v, expected++); }, 3);
+    } while (!q.armed());
+  }
+  producer.join();
+}
+
+void byte_records(std::uint64_t ops) {
+  for (std::size_t cap : {64, 1024}) {
+    fadli::ByteRingBuffer q(cap);
+    // Oversized reservations fail instead of wrapping the size computation
+    CHECK(!q.try_reserve(q.max_record_size() + 1).data());
+    CHECK(!q.try_reserve(SIZE_MAX - 3).data());
+    const auto max_payload = q.max_record_size() - sizeof(std::uint64_t);
+    const auto payload_size = [&](std::uint64_t i) {
+      return sizeof(std::uint64_t) + i * 7 % (max_payload + 1);
+    };
+    std::thread producer([&] {
+      for (std::uint64_t i = 0; i < ops;) {
+        const auto size = payload_size(i);
+        // Over-reserve by a little and commit the exact size
+        const auto reserve = std::min(size + i % 3, q.max_record_size());
+        auto buf = q.try_reserve(reserve);
+        if (!buf.data()) {
+          idle();
+          continue;
+        }
+        std::memcpy(buf.data(), &i, sizeof(i));
+        for (std::size_t k = sizeof(i); k < size; ++k) {
+          buf[k] = static_cast<std::byte>(i + k);
+        }
+        q.commit(size);
+        ++i;
+      }
+    });
+    for (std::uint64_t expected = 0; expected < ops;) {
+      const auto rec = q.front();
+      if (!rec.data()) {
+        idle();
+        continue;
+      }
+      CHECK_EQ(rec.size(), payload_size(expected));
+      std::uint64_t i;
+      std::memcpy(&i, rec.data(), sizeof(i));
+      CHECK_EQ(i, expected);
+      for (std::size_t k = sizeof(i); k < rec.size(); ++k) {
+        CHECK(rec[k] == static_cast<std::byte>(i + k));
+      }
+      q.pop();
+      ++expected;
+    }
+    producer.join();
+    CHECK(q.empty());
+  }
+}
+
+void pipeline(std::uint64_t ops) {
+  std::uint64_t expected = 0;
+  std::uint64_t received = 0;
+  auto p = fadli::make_pipeline<std::uint64_t>(8)
+               .stage([](std::uint64_t& x) { return x * 3; },
+                      {.name = "triple", .max_batch = 5})
+               .stage(
+                   [](std::uint64_t& x) -> std::optional<std::uint64_t> {
+                     if (x % 2 != 0) {
+                       return std::nullopt;
+                     }
+                     return x;
+                   },
+                   {.name = "even", .capacity = 2})
+               .sink(
+                   [&](std::uint64_t& x) {
+                     CHECK_EQ(x, expected);
+                     expected += 6;
+                     ++received;
+                   },
+                   {.name = "sink"});
+  p.start();
+  for (std::uint64_t i = 0; i < ops; ++i) {
+    p.push(i);
+  }
+  p.stop();
+  CHECK_EQ(received, (ops + 1) / 2);
+  CHECK_EQ(p.stats(0).processed, ops);
+  CHECK_EQ(p.stats(2).processed, received);
+}
+
+// A throwing stage commits what it built, then drains without blocking its
+// upstream; stop() rethrows
+void pipeline_throw(std::uint64_t ops) {
+  const std::uint64_t fail_at = ops / 2;
+  std::uint64_t received = 0;
+  auto p = fadli::make_pipeline<std::uint64_t>(8)
+               .stage(
+                   [&](std::uint64_t& x) {
+                     if (x == fail_at) {
+                       throw std::runtime_error("stage failed");
+                     }
+                     return x;
+                   },
+                   {.name = "fail", .cpu = -1000, .max_batch = 5})
+               .sink(
+                   [&](std::uint64_t& x) {
+                     CHECK_EQ(x, received);
+                     ++received;
+                   },
+                   {.name = "sink", .cpu = 1 << 20});
+  p.start();
+  for (std::uint64_t i = 0; i < ops; ++i) {
+    p.push(i);
+  }
+  bool thrown = false;
+  try {
+    p.stop();
+  } catch (const std::runtime_error&) {
+    thrown = true;
+  }
+  CHECK(thrown);
+  CHECK_EQ(received, fail_at);
+  CHECK(!p.stats(0).pinned);
+  CHECK(!p.stats(1).pinned);
+}
+
+// Small segments so the window rolls constantly; a reader replays the files
+// while they are written, and reopening must resume where the ring stopped
+void journal(std::uint64_t ops) {
+  char dir_template[] = "/tmp/fadli-journal-XXXXXX";
+  CHECK(::mkdtemp(dir_template) != nullptr);
+  const std::string dir = dir_template;
+  const fadli::JournalOptions options{
+      .segment_capacity = 16, .window = 2, .sync = fadli::JournalSync::none};
+  {
+    fadli::JournalRingBuffer<std::uint64_t> q(dir, options);
+    CHECK_EQ(q.capacity(), 32u);
+    std::thread producer([&] {
+      std::uint64_t burst = 1;
+      for (std::uint64_t i = 0; i < ops;) {
+        std::uint64_t pushed = 0;
+        burst = burst % 23 + 1;
+        if (i % 3 == 0) {
+          pushed = q.try_push(i) ? 1 : 0;
+        } else if (i % 3 == 1) {
+          std::uint64_t batch[23];
+          const auto n = std::min(burst, ops - i);
+          for (std::uint64_t k = 0; k < n; ++k) {
+            batch[k] = i + k;
+          }
+          pushed = q.try_push_n(std::span<const std::uint64_t>(batch, n));
+        } else {
+          for (auto& slot : q.reserve_n(std::min(burst, ops - i))) {
+            slot = i + pushed++;
+          }
+          q.commit_n(pushed);
+        }
+        if (pushed == 0) {
+          idle();
+        }
+        i += pushed;
+      }
+    });
+    std::thread replayer([&] {
+      fadli::JournalReader<std::uint64_t> reader(dir);
+      CHECK_EQ(reader.segment_capacity(), 16u);
+      std::uint64_t expected = 0;
+      for (std::uint64_t next = 0; next < ops;) {
+        const auto from = next;
+        next = reader.replay(next, [&](const std::uint64_t& v) {
+          CHECK_EQ(v, expected++);
+        });
+        CHECK_EQ(next, expected);
+        if (next == from) {
+          idle();
+        }
+      }
+    });
+    for (std::uint64_t expected = 0; expected < ops;) {
+      if (expected % 2 == 0) {
+        const auto items = q.front_n(7);
+        for (auto v : items) {
+          CHECK_EQ(v, expected++);
+        }
+        q.pop_n(items.size());
+        if (items.empty()) {
+          idle();
+        }
+      } else if (auto v = q.try_pop()) {
+        CHECK_EQ(*v, expected++);
+      } else {
+        idle();
+      }
+    }
+    producer.join();
+    replayer.join();
+    CHECK(q.empty());
+
+    // Leave elements unread; the window has room for 16 wherever head is
+    for (std::uint64_t i = ops; i < ops + 16; ++i) {
+      CHECK(q.try_push(i));
+    }
+    for (std::uint64_t i = ops; i < ops + 5; ++i) {
+      CHECK_EQ(*q.try_pop(), i);
+    }
+    q.sync();
+  }
+  {
+    // The stored segment size wins over the one requested
+    fadli::JournalRingBuffer<std::uint64_t> q(dir, {.segment_capacity = 64});
+    CHECK_EQ(q.segment_capacity(), 16u);
+    CHECK_EQ(q.front_sequence(), ops + 5);
+    CHECK_EQ(q.next_sequence(), ops + 16);
+    CHECK_EQ(q.size(), 11u);
+    CHECK(q.try_push(ops + 16));
+    for (std::uint64_t i = ops + 5; i <= ops + 16; ++i) {
+      CHECK_EQ(*q.try_pop(), i);
+    }
+    CHECK(!q.try_pop());
+  }
+
+  fadli::JournalReader<std::uint64_t> reader(dir);
+  CHECK_EQ(reader.end_sequence(), ops + 17);
+  CHECK_EQ(*reader.read(ops / 2), ops / 2);
+  CHECK(!reader.read(ops + 17));
+  std::uint64_t replayed = 0;
+  CHECK_EQ(reader.replay(ops - 3, [&](const std::uint64_t&) { ++replayed; },
+                         10),
+           ops + 7);
+  CHECK_EQ(replayed, 10u);
+  // Past the end replays nothing and hands back from unchanged
+  replayed = 0;
+  const auto count = [&](const std::uint64_t&) { ++replayed; };
+  CHECK_EQ(reader.replay(ops + 100, count), ops + 100);
+  CHECK_EQ(reader.replay(ops + 100, count, 10), ops + 100);
+  CHECK_EQ(reader.replay(ops + 17, count), ops + 17);
+  CHECK_EQ(replayed, 0u);
+
+  bool rejected = false;
+  try {
+    fadli::JournalReader<std::uint32_t> wrong(dir);
+  } catch (const std::runtime_error&) {
+    rejected = true;
+  }
+  CHECK(rejected);
+  std::filesystem::remove_all(dir);
+}
+
+// Message types of different sizes and alignments, one owning memory and
+// one counting its live instances
+struct Tiny {
+  std::uint8_t i;
+};
+struct alignas(64) Wide {
+  std::uint64_t i;
+  std::uint64_t words[9];
+};
+struct Counted {
+  static inline std::atomic<long> live{0};
+  std::uint64_t i;
+  explicit Counted(std::uint64_t v) noexcept : i(v) { ++live; }
+  Counted(const Counted&) = delete;
+  ~Counted() { --live; }
+};
+using Bus = fadli::MessageRingBuffer<Tiny, std::uint64_t, Wide,
+                                     std::unique_ptr<std::uint64_t>, Counted>;
+
+struct MessageChecker {
+  std::uint64_t& expected;
+
+  void operator()(Tiny& m) { CHECK_EQ(m.i, expected++ % 256); }
+  void operator()(std::uint64_t& m) { CHECK_EQ(m, expected++); }
+  void operator()(Wide& m) {
+    CHECK(reinterpret_cast<std::uintptr_t>(&m) % alignof(Wide) == 0);
+    for (std::uint64_t w = 0; w < 9; ++w) {
+      CHECK_EQ(m.words[w], m.i + w);
+    }
+    CHECK_EQ(m.i, expected++);
+  }
+  void operator()(std::unique_ptr<std::uint64_t>& m) {
+    // Moving out is allowed; the moved-from pointer is destroyed after
+    const auto owned = std::move(m);
+    CHECK_EQ(*owned, expected++);
+  }
+  void operator()(Counted& m) { CHECK_EQ(m.i, expected++); }
+};
+
+void messages(std::uint64_t ops) {
+  for (std::size_t cap : {0, 4096}) {
+    Bus q(cap);
+    CHECK(q.capacity() >= 2 * Bus::message_size<Wide>());
+    std::thread producer([&] {
+      for (std::uint64_t i = 0; i < ops;) {
+        bool pushed = false;
+        switch (i % 5) {
+          case 0:
+            pushed = q.try_push(Tiny{static_cast<std::uint8_t>(i)});
+            break;
+          case 1:
+            pushed = q.try_push(i);
+            break;
+          case 2: {
+            Wide w{i, {}};
+            for (std::uint64_t k = 0; k < 9; ++k) {
+              w.words[k] = i + k;
+            }
+            pushed = q.try_push(w);
+            break;
+          }
+          case 3:
+            pushed = q.try_emplace<std::unique_ptr<std::uint64_t>>(
+                std::make_unique<std::uint64_t>(i));
+            break;
+          default:
+            pushed = q.try_emplace<Counted>(i);
+            break;
+        }
+        if (pushed) {
+          ++i;
+        } else {
+          idle();
+        }
+      }
+    });
+    std::uint64_t expected = 0;
+    MessageChecker checker{expected};
+    while (expected < ops) {
+      if (q.drain(checker, 7) == 0) {
+        idle();
+      }
+    }
+    producer.join();
+    CHECK(q.empty());
+    CHECK_EQ(Counted::live.load(), 0);
+  }
+
+  // Messages left in the buffer are destroyed with it
+  {
+    Bus q(256);
+    CHECK(q.try_emplace<Counted>(1u));
+    CHECK(q.try_emplace<Counted>(2u));
+    CHECK(q.try_push(std::make_unique<std::uint64_t>(3)));
+    CHECK_EQ(Counted::live.load(), 2);
+    std::uint64_t expected = 1;
+    CHECK(q.try_consume(MessageChecker{expected}));
+    CHECK_EQ(Counted::live.load(), 1);
+  }
+  CHECK_EQ(Counted::live.load(), 0);
+  static_assert(Bus::message_size<Tiny>() == 2);
+  static_assert(Bus::message_size<std::uint64_t>() == 16);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const auto ops = fadli::test::stress_ops(argc, argv, 20000);
+  using fadli::test::run;
+  using Word = std::uint64_t;
+
+  run("mpmc", [&] { sequenced<fadli::MPMCRingBuffer<Word>>(2, 2, ops); });
+  run("mpsc", [&] { sequenced<fadli::MPSCRingBuffer<Word>>(3, 1, ops); });
+  run("spmc", [&] { sequenced<fadli::SPMCRingBuffer<Word>>(1, 3, ops); });
+  run("fan-in", [&] { fan_in(ops); });
+  run("broadcast/gated", [&] { broadcast_gated(ops); });
+  run("broadcast/overwrite and lossy", [&] { lossy(ops); });
+  run("conflating", [&] { conflating(ops); });
+  run("unbounded", [&] { unbounded(ops); });
+  run("async", [&] { async(ops); });
+  run("eventfd", [&] { eventfd(ops); });
+  run("byte records", [&] { byte_records(ops); });
+  run("pipeline", [&] { pipeline(ops); });
+  run("pipeline_throw", [&] { pipeline_throw(ops); });
+  run("journal", [&] { journal(ops); });
+  run("messages", [&] { messages(ops); });
+  return 0;
+}
@@ -0,0 +1,442 @@
+/**
+ * @file spsc_stress.cpp
+ * @brief Threaded sequence validation of SPSCRingBuffer.
+ *
+ * Usage: spsc_stress [ops]
+ *
+ * A producer thread pushes a numbered sequence while the consumer checks it
+ * arrives complete, in order and untorn. Every combination of producer and
+ * consumer API is run against tiny and large capacities, element types from
+ * a plain word to owning types, and the non-default Traits (lazy publication,
+ * padded and scrambled slots, prefetching, compile-time capacity), plus the
+ * occupancy snapshot and watermarks against a third observing thread. Run it
+ * under -DFADLI_SANITIZE=thread to have TSan check the memory orderings too.
+ *
+ * ops (or FADLI_STRESS_OPS) is the number of elements per configuration;
+ * the default keeps the whole run to seconds, multi-billion soak runs are
+ * opt-in.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <fadli/SPSCRingBuffer.hpp>
+
+#include "check.hpp"
+
+namespace {
+
+using fadli::SlotLayout;
+using fadli::test::idle;
+
+// How each element type is built from and checked against its sequence number
+template <typename E>
+struct codec;
+
+template <>
+struct codec<std::uint64_t> {
+  static std::uint64_t make(std::uint64_t i) noexcept { return i; }
+  static std::uint64_t value(const std::uint64_t& e) noexcept { return e; }
+};
+
+// A full cache line whose every word is derived from the sequence number, so
+// a torn or partially published copy is caught
+struct Line {
+  std::uint64_t words[8];
+};
+
+template <>
+struct codec<Line> {
+  static Line make(std::uint64_t i) noexcept {
+    Line line;
+    for (std::uint64_t w = 0; w < 8; ++w) {
+      line.words[w] = i * 8 + w;
+    }
+    return line;
+  }
+  static std::uint64_t value(const Line& e) noexcept {
+    for (std::uint64_t w = 1; w < 8; ++w) {
+      CHECK_EQ(e.words[w], e.words[0] + w);
+    }
+    return e.words[0] / 8;
+  }
+};
+
+// Long enough to sit on the heap, so ownership transfer is exercised
+template <>
+struct codec<std::string> {
+  static std::string make(std::uint64_t i) {
+    auto s = std::to_string(i);
+    s.insert(0, 40 - s.size(), '0');
+    return s;
+  }
+  static std::uint64_t value(const std::string& e) { return std::stoull(e); }
+};
+
+template <>
+struct codec<std::unique_ptr<std::uint64_t>> {
+  static std::unique_ptr<std::uint64_t> make(std::uint64_t i) {
+    return std::make_unique<std::uint64_t>(i);
+  }
+  static std::uint64_t value(const std::unique_ptr<std::uint64_t>& e) {
+    CHECK(e != nullptr);
+    return *e;
+  }
+};
+
+// Generates elements on dereference, so try_push_n() also works on move-only
+// types and only the elements actually pushed are built
+template <typename E>
+struct sequence_iterator {
+  using iterator_concept = std::forward_iterator_tag;
+  using iterator_category = std::input_iterator_tag;
+  using value_type = E;
+  using difference_type = std::ptrdiff_t;
+
+  std::uint64_t i = 0;
+
+  E operator*() const { return codec<E>::make(i); }
+  sequence_iterator& operator++() noexcept {
+    ++i;
+    return *this;
+  }
+  sequence_iterator operator++(int) noexcept { return {i++}; }
+  bool operator==(const sequence_iterator&) const = default;
+};
+
+enum class Produce { try_push, try_push_n, push_span, reserve_n, blocking };
+enum class Consume { try_pop, front, front_n, try_pop_n, drain, blocking };
+
+template <typename Queue>
+constexpr bool contiguous =
+    Queue::traits_type::slot_layout == SlotLayout::contiguous;
+
+template <typename Queue>
+void produce(Queue& q, Produce mode, std::uint64_t ops) {
+  using E = typename Queue::value_type;
+  using C = codec<E>;
+  std::uint64_t next = 0;
+  std::uint64_t burst = 1;
+  while (next < ops) {
+    std::uint64_t pushed = 0;
+    switch (mode) {
+      case Produce::try_push:
+        pushed = q.try_push(C::make(next)) ? 1 : 0;
+        break;
+      case Produce::try_push_n: {
+        // Vary the batch so it lands on every offset relative to the wrap
+        burst = burst % 37 + 1;
+        const auto last = std::min(next + burst, ops);
+        pushed = q.try_push_n(sequence_iterator<E>{next},
+                              sequence_iterator<E>{last});
+        break;
+      }
+      case Produce::push_span:
+        // From a contiguous range, the memcpy path for trivially copyable E
+        if constexpr (std::is_copy_constructible_v<E>) {
+          burst = burst % 37 + 1;
+          std::vector<E> batch;
+          for (auto i = next; i < std::min(next + burst, ops); ++i) {
+            batch.push_back(C::make(i));
+          }
+          pushed = q.try_push_n(std::span<const E>(batch));
+        }
+        break;
+      case Produce::reserve_n:
+        if constexpr (contiguous<Queue>) {
+          burst = burst % 37 + 1;
+          auto slots = q.reserve_n(std::min(burst, ops - next));
+          for (auto& s : slots.first) {
+            std::construct_at(&s, C::make(next + pushed++));
+          }
+          for (auto& s : slots.second) {
+            std::construct_at(&s, C::make(next + pushed++));
+          }
+          if (pushed != 0) {
+            q.commit_n(pushed);
+          }
+        }
+        break;
+      case Produce::blocking:
+        q.push(C::make(next));
+        pushed = 1;
+        break;
+    }
+    if (pushed == 0) {
+      idle();
+    }
+    next += pushed;
+  }
+  q.flush();
+}
+
+template <typename Queue>
+void consume(Queue& q, Consume mode, std::uint64_t ops) {
+  using E = typename Queue::value_type;
+  using C = codec<E>;
+  std::uint64_t expected = 0;
+  std::uint64_t burst = 1;
+  while (expected < ops) {
+    const auto before = expected;
+    switch (mode) {
+      case Consume::try_pop:
+        if (auto item = q.try_pop()) {
+          CHECK_EQ(C::value(*item), expected++);
+        }
+        break;
+      case Consume::front:
+        if (auto* item = q.front()) {
+          CHECK_EQ(C::value(*item), expected++);
+          q.pop();
+        }
+        break;
+      case Consume::front_n:
+        if constexpr (contiguous<Queue>) {
+          burst = burst % 29 + 1;
+          auto items = q.front_n(burst);
+          for (const auto& e : items.first) {
+            CHECK_EQ(C::value(e), expected++);
+          }
+          for (const auto& e : items.second) {
+            CHECK_EQ(C::value(e), expected++);
+          }
+          q.pop_n(items.size());
+        }
+        break;
+      case Consume::try_pop_n:
+        if constexpr (contiguous<Queue>) {
+          burst = burst % 29 + 1;
+          E out[29];
+          const auto popped = q.try_pop_n(std::span(out, burst));
+          for (std::size_t i = 0; i < popped; ++i) {
+            CHECK_EQ(C::value(out[i]), expected++);
+          }
+        }
+        break;
+      case Consume::drain:
+        if constexpr (contiguous<Queue>) {
+          burst = burst % 29 + 1;
+          q.drain(
+              [&](std::span<E> items) {
+                for (const auto& e : items) {
+                  CHECK_EQ(C::value(e), expected++);
+                }
+              },
+              burst);
+        }
+        break;
+      case Consume::blocking:
+        CHECK_EQ(C::value(q.pop_wait()), expected++);
+        break;
+    }
+    if (expected == before) {
+      idle();
+    }
+  }
+  q.flush_consumer();
+  CHECK(q.empty());
+}
+
+template <typename Queue>
+void run_pair(Queue& q, Produce p, Consume c, std::uint64_t ops) {
+  std::thread producer([&] { produce(q, p, ops); });
+  consume(q, c, ops);
+  producer.join();
+}
+
+// With Traits::blocking a parked side must be woken by the other's
+// non-blocking calls too, so blocking calls are paired with every kind of
+// publish; without it only with each other
+template <typename Queue>
+void run_modes(Queue& q, std::uint64_t ops) {
+  run_pair(q, Produce::try_push, Consume::try_pop, ops);
+  run_pair(q, Produce::try_push, Consume::front, ops);
+  run_pair(q, Produce::try_push_n, Consume::try_pop, ops);
+  run_pair(q, Produce::blocking, Consume::blocking, ops);
+  if constexpr (Queue::traits_type::blocking) {
+    run_pair(q, Produce::blocking, Consume::try_pop, ops);
+    run_pair(q, Produce::blocking, Consume::front, ops);
+    run_pair(q, Produce::try_push, Consume::blocking, ops);
+    run_pair(q, Produce::try_push_n, Consume::blocking, ops);
+    if constexpr (contiguous<Queue>) {
+      run_pair(q, Produce::blocking, Consume::front_n, ops);
+      run_pair(q, Produce::blocking, Consume::drain, ops);
+      run_pair(q, Produce::reserve_n, Consume::blocking, ops);
+    }
+  }
+  if constexpr (contiguous<Queue>) {
+    run_pair(q, Produce::try_push, Consume::front_n, ops);
+    run_pair(q, Produce::try_push_n, Consume::front_n, ops);
+    run_pair(q, Produce::reserve_n, Consume::front, ops);
+    run_pair(q, Produce::reserve_n, Consume::front_n, ops);
+    run_pair(q, Produce::try_push_n, Consume::try_pop_n, ops);
+    if constexpr (std::is_copy_constructible_v<typename Queue::value_type>) {
+      run_pair(q, Produce::push_span, Consume::try_pop_n, ops);
+      run_pair(q, Produce::push_span, Consume::front, ops);
+    }
+    run_pair(q, Produce::try_push, Consume::drain, ops);
+  }
+}
+
+template <std::size_t Interval, SlotLayout Layout = SlotLayout::contiguous>
+struct StressTraits : fadli::SPSCRingBufferTraits {
+  static constexpr std::size_t publish_interval = Interval;
+  static constexpr SlotLayout slot_layout = Layout;
+};
+
+template <std::size_t Interval>
+struct BlockingTraits : StressTraits<Interval> {
+  static constexpr bool blocking = true;
+};
+
+template <fadli::CacheHint Hint>
+struct PrefetchTraits : fadli::SPSCRingBufferTraits {
+  static constexpr std::size_t prefetch_distance = 3;
+  static constexpr fadli::CacheHint publish_hint = Hint;
+};
+
+template <typename E, typename Traits = fadli::SPSCRingBufferTraits>
+using Dynamic = fadli::SPSCRingBuffer<E, fadli::dynamic_capacity,
+                                      fadli::AlignedAllocator<E>, Traits>;
+
+template <typename E>
+void run_element(const char* name, std::uint64_t ops) {
+  for (std::size_t cap : {1, 2, 64, 1024}) {
+    const auto label = std::string(name) + "/capacity " + std::to_string(cap);
+    fadli::test::run(label.c_str(), [&] {
+      Dynamic<E> q(cap);
+      run_modes(q, ops);
+    });
+  }
+}
+
+// Watermark events must alternate, starting with high, and report
+// occupancies on the right side of their threshold; every snapshot an
+// observer takes must be possible and monotonic
+void watermarks(std::uint64_t ops) {
+  fadli::SPSCRingBuffer<std::uint64_t> q(64);
+  std::uint64_t highs = 0;
+  std::uint64_t lows = 0;
+  q.set_watermarks(48, 16, [&](fadli::Watermark level, std::size_t occupancy) {
+    if (level == fadli::Watermark::high) {
+      CHECK_EQ(highs, lows);
+      CHECK(occupancy >= 48);
+      ++highs;
+    } else {
+      CHECK_EQ(highs, lows + 1);
+      CHECK(occupancy <= 16);
+      ++lows;
+    }
+  });
+  std::atomic<bool> done{false};
+  std::thread observer([&] {
+    decltype(q.occupancy()) last{0, 0};
+    while (!done.load(std::memory_order_relaxed)) {
+      const auto now = q.occupancy();
+      CHECK(now.pushed >= last.pushed && now.popped >= last.popped);
+      CHECK(now.popped <= now.pushed && now.size() <= q.capacity());
+      CHECK(q.popped_count() >= now.popped);
+      last = now;
+      idle();
+    }
+  });
+  std::thread producer([&] {
+    for (std::uint64_t i = 0; i < ops;) {
+      // Shed while above, as a flow-controlled producer would
+      if (q.above_high_watermark() && i % 2 == 0) {
+        idle();
+        continue;
+      }
+      if (q.try_push(i)) {
+        ++i;
+      } else {
+        idle();
+      }
+    }
+  });
+  // Consume in bursts so occupancy swings across both watermarks
+  std::uint64_t expected = 0;
+  while (expected < ops) {
+    idle();
+    while (auto item = q.try_pop()) {
+      CHECK_EQ(*item, expected++);
+    }
+  }
+  producer.join();
+  done.store(true, std::memory_order_relaxed);
+  observer.join();
+  CHECK_EQ(q.pushed_count(), ops);
+  CHECK_EQ(q.occupancy().size(), 0u);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const auto ops = fadli::test::stress_ops(argc, argv, 20000);
+  using fadli::test::run;
+
+  run_element<std::uint64_t>("uint64", ops);
+  run_element<Line>("cache line", ops);
+  run_element<std::string>("string", ops);
+  run_element<std::unique_ptr<std::uint64_t>>("unique_ptr", ops);
+
+  run("static capacity", [&] {
+    fadli::SPSCRingBuffer<std::uint64_t, 8> q;
+    run_modes(q, ops);
+  });
+  run("lazy publish", [&] {
+    for (std::size_t cap : {1, 4, 256}) {
+      Dynamic<std::uint64_t, StressTraits<8>> q(cap);
+      run_modes(q, ops);
+    }
+  });
+  run("lazy publish/string", [&] {
+    Dynamic<std::string, StressTraits<3>> q(16);
+    run_modes(q, ops);
+  });
+  run("prefetch", [&] {
+    for (std::size_t cap : {2, 64}) {
+      Dynamic<std::uint64_t, PrefetchTraits<fadli::CacheHint::none>> q(cap);
+      run_modes(q, ops);
+    }
+  });
+  run("prefetch/demote", [&] {
+    for (std::size_t cap : {1, 64}) {
+      Dynamic<Line, PrefetchTraits<fadli::CacheHint::demote>> q(cap);
+      run_modes(q, ops);
+    }
+  });
+  run("padded slots", [&] {
+    Dynamic<std::uint64_t, StressTraits<1, SlotLayout::padded>> q(16);
+    run_modes(q, ops);
+  });
+  run("scrambled slots", [&] {
+    for (std::size_t cap : {2, 64, 1024}) {
+      Dynamic<std::uint64_t, StressTraits<1, SlotLayout::scrambled>> q(cap);
+      run_modes(q, ops);
+    }
+  });
+  run("blocking wake", [&] {
+    for (std::size_t cap : {1, 64}) {
+      Dynamic<std::uint64_t, BlockingTraits<1>> q(cap);
+      run_modes(q, ops);
+    }
+  });
+  run("blocking wake/lazy", [&] {
+    Dynamic<std::string, BlockingTraits<3>> q(16);
+    run_modes(q, ops);
+  });
+  run("watermarks", [&] { watermarks(ops); });
+  run("scrambled slots/lazy", [&] {
+    Dynamic<std::uint64_t, StressTraits<4, SlotLayout::scrambled>> q(128);
+    run_modes(q, ops);
+  });
+  return 0;
+}
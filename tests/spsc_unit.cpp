@@ -0,0 +1,407 @@
+/**
+ * @file spsc_unit.cpp
+ * @brief Single-threaded semantics of SPSCRingBuffer.
+ *
+ * Covers capacity rounding, FIFO order across many wraps, element lifetimes
+ * (every constructed element is destroyed exactly once, including those left
+ * in the buffer), the batched span APIs at the wrap point, pushing ranges
+ * through move iterators, lazy publication, the occupancy counters and
+ * watermarks, and every slot layout.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fadli/SPSCRingBuffer.hpp>
+
+#include "check.hpp"
+
+namespace {
+
+using fadli::SlotLayout;
+using fadli::SPSCRingBuffer;
+
+// Counts live instances so leaks and double destruction show up
+struct Tracked {
+  static inline long live = 0;
+  std::uint64_t value;
+
+  explicit Tracked(std::uint64_t v) noexcept : value(v) { ++live; }
+  Tracked(const Tracked& other) noexcept : value(other.value) { ++live; }
+  Tracked(Tracked&& other) noexcept : value(other.value) { ++live; }
+  Tracked& operator=(const Tracked&) = default;
+  ~Tracked() { --live; }
+};
+
+template <std::size_t Interval>
+struct LazyTraits : fadli::SPSCRingBufferTraits {
+  static constexpr std::size_t publish_interval = Interval;
+};
+
+template <SlotLayout Layout>
+struct LayoutTraits : fadli::SPSCRingBufferTraits {
+  static constexpr SlotLayout slot_layout = Layout;
+};
+
+void capacity_rounding() {
+  CHECK_EQ(SPSCRingBuffer<int>(0).capacity(), 1u);
+  CHECK_EQ(SPSCRingBuffer<int>(1).capacity(), 1u);
+  CHECK_EQ(SPSCRingBuffer<int>(5).capacity(), 8u);
+  CHECK_EQ(SPSCRingBuffer<int>(64).capacity(), 64u);
+  CHECK_EQ((SPSCRingBuffer<int, 100>().capacity()), 128u);
+}
+
+template <typename Queue>
+void fifo_across_wraps(Queue& q) {
+  const auto cap = q.capacity();
+  std::uint64_t pushed = 0;
+  std::uint64_t popped = 0;
+  // Fill and drain by uneven amounts so every offset is a wrap point once
+  for (std::size_t round = 0; round < 4 * cap + 7; ++round) {
+    const auto burst = round % (cap + 1);
+    for (std::size_t i = 0; i < burst; ++i) {
+      if (!q.try_push(pushed)) {
+        break;
+      }
+      ++pushed;
+    }
+    CHECK(q.size() <= cap);
+    for (std::size_t i = 0; i < (round * 7) % (cap + 1); ++i) {
+      auto item = q.try_pop();
+      if (!item) {
+        break;
+      }
+      CHECK_EQ(static_cast<std::uint64_t>(*item), popped);
+      ++popped;
+    }
+  }
+  q.flush();
+  while (auto item = q.try_pop()) {
+    CHECK_EQ(static_cast<std::uint64_t>(*item), popped);
+    ++popped;
+  }
+  CHECK_EQ(popped, pushed);
+  CHECK(q.empty());
+}
+
+void full_and_empty() {
+  SPSCRingBuffer<int> q(4);
+  CHECK(q.empty());
+  CHECK(q.front() == nullptr);
+  CHECK(!q.try_pop());
+  for (int i = 0; i < 4; ++i) {
+    CHECK(q.try_push(i));
+  }
+  CHECK(q.full());
+  CHECK(!q.try_push(4));
+  CHECK(q.try_reserve() == nullptr);
+  CHECK_EQ(*q.front(), 0);
+  q.pop();
+  CHECK(q.try_push(4));
+  for (int i = 1; i <= 4; ++i) {
+    CHECK_EQ(*q.try_pop(), i);
+  }
+  CHECK(q.empty());
+}
+
+void lifetimes() {
+  Tracked::live = 0;
+  {
+    SPSCRingBuffer<Tracked> q(8);
+    for (std::uint64_t i = 0; i < 8; ++i) {
+      CHECK(q.try_emplace(i));
+    }
+    CHECK_EQ(Tracked::live, 8);
+    q.pop();
+    CHECK_EQ(Tracked::live, 7);
+    {
+      auto item = q.try_pop();
+      CHECK_EQ(item->value, 1u);
+    }
+    CHECK_EQ(Tracked::live, 6);
+    // Pushing after a wrap then destroying the buffer must release the rest
+    CHECK(q.try_emplace(8u));
+    CHECK(q.try_emplace(9u));
+    q.pop_n(q.front_n(3).size());
+    CHECK_EQ(Tracked::live, 5);
+  }
+  CHECK_EQ(Tracked::live, 0);
+
+  {
+    SPSCRingBuffer<std::unique_ptr<int>> q(2);
+    CHECK(q.try_push(std::make_unique<int>(1)));
+    CHECK(q.try_push(std::make_unique<int>(2)));
+    CHECK_EQ(**q.try_pop(), 1);
+  }
+}
+
+void batched_spans() {
+  SPSCRingBuffer<int> q(8);
+  // Move the indices next to the wrap point first
+  for (int i = 0; i < 6; ++i) {
+    CHECK(q.try_push(-1));
+  }
+  q.pop_n(q.front_n(6).size());
+
+  std::vector<int> input(10);
+  std::iota(input.begin(), input.end(), 0);
+  CHECK_EQ(q.try_push_n(std::span<const int>(input)), 8u);
+
+  auto readable = q.front_n(5);
+  CHECK_EQ(readable.size(), 5u);
+  CHECK_EQ(readable.first.size(), 2u);
+  CHECK_EQ(readable.second.size(), 3u);
+  CHECK_EQ(readable.first[0], 0);
+  CHECK_EQ(readable.second[0], 2);
+  q.pop_n(readable.size());
+
+  auto all = q.read_available();
+  CHECK_EQ(all.size(), 3u);
+  CHECK(all.second.empty());
+  CHECK_EQ(all.first[0], 5);
+  q.pop_n(3);
+  CHECK(q.empty());
+
+  // reserve_n hands out uninitialized slots up to the free space
+  auto writable = q.reserve_n(100);
+  CHECK_EQ(writable.size(), 8u);
+  CHECK_EQ(writable.first.size(), 2u);
+  std::construct_at(&writable.first[0], 10);
+  std::construct_at(&writable.first[1], 11);
+  std::construct_at(&writable.second[0], 12);
+  q.commit_n(3);
+  CHECK_EQ(q.size(), 3u);
+  CHECK_EQ(*q.try_pop(), 10);
+  CHECK_EQ(*q.try_pop(), 11);
+  CHECK_EQ(*q.try_pop(), 12);
+
+  auto* slot = q.try_reserve();
+  CHECK(slot != nullptr);
+  std::construct_at(slot, 42);
+  q.commit();
+  CHECK_EQ(*q.front(), 42);
+  q.pop();
+}
+
+void bulk_copy_and_drain() {
+  SPSCRingBuffer<std::int64_t> q(8);
+  for (int i = 0; i < 5; ++i) {
+    CHECK(q.try_push(-1));
+  }
+  q.pop_n(q.front_n(5).size());
+
+  // Trivially copyable ranges are copied per wrap segment
+  std::vector<std::int64_t> prices(10);
+  std::iota(prices.begin(), prices.end(), 100);
+  CHECK_EQ(q.try_push_n(prices.begin(), prices.end()), 8u);
+
+  std::int64_t out[3] = {};
+  CHECK_EQ(q.try_pop_n(std::span(out, 1)), 1u);
+  CHECK_EQ(out[0], 100);
+
+  // drain() sees the elements in place, split at the wrap point
+  std::vector<std::size_t> segments;
+  const auto drained = q.drain(
+      [&](std::span<std::int64_t> batch) {
+        segments.push_back(batch.size());
+        for (auto& p : batch) {
+          p *= 10;
+        }
+        CHECK_EQ(batch[0], segments.size() == 1 ? 1010 : 1030);
+      },
+      4);
+  CHECK_EQ(drained, 4u);
+  CHECK_EQ(segments.size(), 2u);
+
+  CHECK_EQ(q.try_pop_n(out), 3u);
+  CHECK_EQ(out[0], 105);
+  CHECK_EQ(out[2], 107);
+  CHECK(q.empty());
+  CHECK_EQ(q.drain([](std::span<std::int64_t>) {}), 0u);
+
+  // Non-trivial elements are moved out one by one
+  SPSCRingBuffer<std::string> strings(4);
+  const std::string long_string(64, 'x');
+  for (int i = 0; i < 4; ++i) {
+    CHECK(strings.try_push(long_string + std::to_string(i)));
+  }
+  std::string taken[8];
+  CHECK_EQ(strings.try_pop_n(taken), 4u);
+  CHECK_EQ(taken[3], long_string + "3");
+  CHECK_EQ(strings.try_pop_n(taken), 0u);
+}
+
+// try_push_n() takes move iterators, which are only input iterators in
+// C++20, as long as the range is sized
+void move_iterator_ranges() {
+  SPSCRingBuffer<std::string> q(4);
+  CHECK(q.try_push(std::string("skip")));
+  q.pop();
+
+  const std::string long_string(64, 'y');
+  std::vector<std::string> input;
+  for (int i = 0; i < 6; ++i) {
+    input.push_back(long_string + std::to_string(i));
+  }
+  CHECK_EQ(q.try_push_n(std::make_move_iterator(input.begin()),
+                        std::make_move_iterator(input.end())),
+           4u);
+  for (int i = 0; i < 4; ++i) {
+    CHECK_EQ(*q.try_pop(), long_string + std::to_string(i));
+  }
+  CHECK_EQ(input[4], long_string + "4");
+
+  // Move-only elements can only get in this way
+  SPSCRingBuffer<std::unique_ptr<int>> owners(2);
+  std::vector<std::unique_ptr<int>> pointers;
+  pointers.push_back(std::make_unique<int>(1));
+  pointers.push_back(std::make_unique<int>(2));
+  CHECK_EQ(owners.try_push_n(std::make_move_iterator(pointers.begin()),
+                             std::make_move_iterator(pointers.end())),
+           2u);
+  CHECK(!pointers[0] && !pointers[1]);
+  CHECK_EQ(**owners.front(), 1);
+}
+
+void lazy_publication() {
+  SPSCRingBuffer<int, fadli::dynamic_capacity, fadli::AlignedAllocator<int>,
+                 LazyTraits<4>>
+      q(16);
+  CHECK(q.try_push(1));
+  CHECK(q.try_push(2));
+  // Below the interval nothing is visible until the producer flushes
+  CHECK(q.front() == nullptr);
+  q.flush();
+  CHECK_EQ(*q.try_pop(), 1);
+  CHECK_EQ(*q.try_pop(), 2);
+
+  for (int i = 0; i < 4; ++i) {
+    CHECK(q.try_push(i));
+  }
+  CHECK(q.front() != nullptr);
+
+  // A full buffer publishes everything before reporting failure
+  SPSCRingBuffer<int, fadli::dynamic_capacity, fadli::AlignedAllocator<int>,
+                 LazyTraits<64>>
+      small(2);
+  CHECK(small.try_push(1));
+  CHECK(small.try_push(2));
+  CHECK(!small.try_push(3));
+  CHECK_EQ(*small.try_pop(), 1);
+}
+
+void counters_and_watermarks() {
+  SPSCRingBuffer<int> q(8);
+  std::vector<std::pair<fadli::Watermark, std::size_t>> events;
+  q.set_watermarks(6, 2, [&](fadli::Watermark level, std::size_t occupancy) {
+    events.emplace_back(level, occupancy);
+  });
+
+  for (int i = 0; i < 6; ++i) {
+    CHECK(q.try_push(i));
+  }
+  CHECK(events.empty());
+  CHECK(!q.above_high_watermark());
+  // The next push reloads head_ and sees the high watermark reached
+  CHECK(q.try_push(6));
+  CHECK_EQ(events.size(), 1u);
+  CHECK(events[0].first == fadli::Watermark::high);
+  CHECK_EQ(events[0].second, 6u);
+  CHECK(q.above_high_watermark());
+
+  q.pop_n(q.front_n(3).size());
+  CHECK(q.above_high_watermark());
+  q.pop_n(q.front_n(2).size());
+  // A producer shedding load sees the fall without pushing
+  CHECK(!q.above_high_watermark());
+  CHECK_EQ(events.size(), 2u);
+  CHECK(events[1].first == fadli::Watermark::low);
+  CHECK_EQ(events[1].second, 2u);
+
+  CHECK_EQ(q.pushed_count(), 7u);
+  CHECK_EQ(q.popped_count(), 5u);
+  const auto snapshot = q.occupancy();
+  CHECK_EQ(snapshot.pushed, 7u);
+  CHECK_EQ(snapshot.popped, 5u);
+  CHECK_EQ(snapshot.size(), 2u);
+
+  // Without watermarks the buffer still fills up completely
+  q.clear_watermarks();
+  for (int i = 0; i < 6; ++i) {
+    CHECK(q.try_push(i));
+  }
+  CHECK(!q.try_push(6));
+  CHECK_EQ(events.size(), 2u);
+  CHECK_EQ(q.occupancy().size(), 8u);
+}
+
+void timed_calls() {
+  using namespace std::chrono_literals;
+  SPSCRingBuffer<int> q(1);
+  CHECK(!q.try_pop_for(1ms));
+  CHECK(q.try_push_for(1, 1ms));
+  CHECK(!q.try_push_for(2, 1ms));
+  CHECK_EQ(q.pop_wait(), 1);
+}
+
+}  // namespace
+
+int main() {
+  using fadli::test::run;
+
+  run("capacity_rounding", capacity_rounding);
+  run("full_and_empty", full_and_empty);
+  run("lifetimes", lifetimes);
+  run("batched_spans", batched_spans);
+  run("bulk_copy_and_drain", bulk_copy_and_drain);
+  run("move_iterator_ranges", move_iterator_ranges);
+  run("lazy_publication", lazy_publication);
+  run("counters_and_watermarks", counters_and_watermarks);
+  run("timed_calls", timed_calls);
+
+  run("fifo/dynamic", [] {
+    for (std::size_t cap : {1, 2, 4, 8, 64}) {
+      SPSCRingBuffer<std::uint64_t> q(cap);
+      fifo_across_wraps(q);
+    }
+  });
+  run("fifo/static", [] {
+    SPSCRingBuffer<std::uint64_t, 16> q;
+    fifo_across_wraps(q);
+  });
+  run("fifo/lazy", [] {
+    SPSCRingBuffer<std::uint64_t, fadli::dynamic_capacity,
+                   fadli::AlignedAllocator<std::uint64_t>, LazyTraits<3>>
+        q(8);
+    fifo_across_wraps(q);
+  });
+  run("fifo/padded", [] {
+    SPSCRingBuffer<std::uint64_t, fadli::dynamic_capacity,
+                   fadli::AlignedAllocator<std::uint64_t>,
+                   LayoutTraits<SlotLayout::padded>>
+        q(16);
+    fifo_across_wraps(q);
+  });
+  run("fifo/scrambled", [] {
+    for (std::size_t cap : {1, 4, 16, 256}) {
+      SPSCRingBuffer<std::uint64_t, fadli::dynamic_capacity,
+                     fadli::AlignedAllocator<std::uint64_t>,
+                     LayoutTraits<SlotLayout::scrambled>>
+          q(cap);
+      fifo_across_wraps(q);
+    }
+  });
+  run("fifo/static_scrambled", [] {
+    SPSCRingBuffer<std::uint32_t, 64, fadli::AlignedAllocator<std::uint32_t>,
+                   LayoutTraits<SlotLayout::scrambled>>
+        q;
+    fifo_across_wraps(q);
+  });
+  return 0;
+}